@@ -0,0 +1,152 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#define ANKERL_NANOBENCH_IMPLEMENT
+#include <nanobench.h>
+
+#include <lexy/action/batch_parse.hpp>
+#include <lexy/action/parse.hpp>
+#include <lexy/callback.hpp>
+#include <lexy/dsl.hpp>
+#include <lexy/input/string_input.hpp>
+#include <lexy/memory_resource.hpp>
+#include <string>
+#include <vector>
+
+namespace grammar
+{
+namespace dsl = lexy::dsl;
+
+// key=value
+struct field
+{
+    static constexpr auto rule = [] {
+        auto key   = dsl::identifier(dsl::ascii::alpha_underscore, dsl::ascii::alpha_digit_underscore);
+        auto value = dsl::integer<long long>(dsl::digits<>);
+        return key + dsl::lit_c<'='> + value;
+    }();
+    static constexpr auto value
+        = lexy::callback<long long>([](auto, long long value) { return value; });
+};
+
+// key=value;key=value;...
+struct message
+{
+    static constexpr auto rule  = dsl::list(dsl::p<field>, dsl::sep(dsl::lit_c<';'>)) + dsl::eof;
+    static constexpr auto value = lexy::fold_inplace<long long>(0, [](long long& sum,
+                                                                      long long value) {
+        sum += value;
+    });
+};
+
+// Same as message, but the values are collected in a list allocated from the arena.
+struct message_list
+{
+    using allocator = lexy::resource_allocator<long long, lexy::arena_resource<>>;
+    using list      = std::vector<long long, allocator>;
+
+    static constexpr auto rule  = dsl::list(dsl::p<field>, dsl::sep(dsl::lit_c<';'>)) + dsl::eof;
+    static constexpr auto value = lexy::as_list<list>;
+};
+} // namespace grammar
+
+using input_t = lexy::string_input<lexy::default_encoding>;
+
+constexpr auto error_callback
+    = lexy::callback<const char*>([](const auto& context, const auto&) { return context.production(); });
+
+// Generates messages of about 200 bytes, every tenth one is invalid.
+std::vector<std::string> generate_messages(std::size_t count)
+{
+    std::vector<std::string> result;
+    for (auto i = 0u; i != count; ++i)
+    {
+        std::string message;
+        for (auto field = 0u; message.size() < 200; ++field)
+        {
+            if (field > 0)
+                message += ';';
+            message += "field_" + std::to_string(field) + "=" + std::to_string(i * field);
+        }
+        if (i % 10 == 9)
+            message += ";invalid";
+
+        result.push_back(LEXY_MOV(message));
+    }
+    return result;
+}
+
+int main()
+{
+    auto messages = generate_messages(1000);
+    auto bytes    = std::size_t(0);
+    for (auto& message : messages)
+        bytes += message.size();
+
+    ankerl::nanobench::Bench b;
+    b.title("1000 messages").relative(true);
+    b.unit("byte").batch(bytes);
+    b.minEpochIterations(100);
+
+    b.run("lexy::parse", [&] {
+        auto sum = 0ll;
+        for (auto& message : messages)
+        {
+            auto input  = input_t(message.data(), message.size());
+            auto result = lexy::parse<grammar::message>(input, lexy::collect<std::vector<const char*>>(
+                                                                   error_callback));
+            if (result.has_value())
+                sum += result.value();
+        }
+        return sum;
+    });
+
+    b.run("lexy::batch_parser", [&] {
+        lexy::batch_parser<grammar::message, input_t, LEXY_DECAY_DECLTYPE(error_callback)> parser(
+            error_callback);
+
+        auto sum = 0ll;
+        for (auto& message : messages)
+        {
+            auto input  = input_t(message.data(), message.size());
+            auto result = parser.parse(input);
+            if (result.has_value())
+                sum += result.value();
+        }
+        return sum;
+    });
+
+    b.run("lexy::parse with arena", [&] {
+        auto sum = 0ll;
+        for (auto& message : messages)
+        {
+            lexy::arena_resource<> arena;
+
+            auto input  = input_t(message.data(), message.size());
+            auto result = lexy::parse<grammar::message_list>(input, lexy::with_arena(arena),
+                                                             lexy::noop);
+            if (result.has_value())
+                sum += result.value().back();
+        }
+        return sum;
+    });
+
+    b.run("lexy::batch_parser with arena", [&] {
+        lexy::arena_resource<> arena;
+        auto                   state = lexy::with_arena(arena);
+        using noop_callback = LEXY_DECAY_DECLTYPE(lexy::noop);
+        lexy::batch_parser<grammar::message_list, input_t, noop_callback, decltype(state)> parser(
+            state);
+
+        auto sum = 0ll;
+        for (auto& message : messages)
+        {
+            auto input  = input_t(message.data(), message.size());
+            auto result = parser.parse(input);
+            if (result.has_value())
+                sum += result.value().back();
+        }
+        return sum;
+    });
+}
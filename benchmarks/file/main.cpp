@@ -9,7 +9,8 @@
 #include <fstream>
 #include <lexy/input/file.hpp>
 
-std::size_t use_buffer(const lexy::buffer<>& buffer)
+template <typename Encoding, typename MemoryResource>
+std::size_t use_buffer(const lexy::buffer<Encoding, MemoryResource>& buffer)
 {
     std::size_t sum = 0;
     for (auto ptr = buffer.data(); ptr != buffer.data() + buffer.size(); ++ptr)
@@ -27,6 +28,20 @@ std::size_t file_lexy(const char* path)
     return use_buffer(result.buffer());
 }
 
+std::size_t file_lexy_huge_pages(const char* path)
+{
+    auto result = lexy::read_file<lexy::default_encoding, lexy::encoding_endianness::bom,
+                                  lexy::huge_page_resource>(path);
+    return use_buffer(result.buffer());
+}
+
+template <typename Encoding, lexy::encoding_endianness Endian>
+std::size_t file_lexy_encoding(const char* path)
+{
+    auto result = lexy::read_file<Encoding, Endian>(path);
+    return use_buffer(result.buffer());
+}
+
 std::size_t file_cfile(const char* path)
 {
     auto file = std::fopen(path, "rb");
@@ -82,6 +97,16 @@ int main()
         auto benchmark = [&](auto f) { return [f] { return f(bm_file_path); }; };
 
         b.run("lexy", benchmark(file_lexy));
+        if (size >= 2 * 1024 * 1024)
+            b.run("lexy (huge pages)", benchmark(file_lexy_huge_pages));
+
+        using endian = lexy::encoding_endianness;
+        b.run("lexy (UTF-16 LE)",
+              benchmark(file_lexy_encoding<lexy::utf16_encoding, endian::little>));
+        b.run("lexy (UTF-16 BE)", benchmark(file_lexy_encoding<lexy::utf16_encoding, endian::big>));
+        b.run("lexy (UTF-32 LE)",
+              benchmark(file_lexy_encoding<lexy::utf32_encoding, endian::little>));
+        b.run("lexy (UTF-32 BE)", benchmark(file_lexy_encoding<lexy::utf32_encoding, endian::big>));
 
         b.run("cfile", benchmark(file_cfile));
         b.run("stream", benchmark(file_stream));
@@ -99,6 +124,8 @@ int main()
     bench_data("128 KiB", 128 * 1024, 1000);
 
     bench_data("1 MiB", 1024 * 1024, 100);
+    bench_data("16 MiB", 16 * 1024 * 1024, 10);
+    bench_data("256 MiB", 256 * 1024 * 1024, 1);
 
     std::remove(bm_file_path);
 }
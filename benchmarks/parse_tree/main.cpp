@@ -0,0 +1,173 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#define ANKERL_NANOBENCH_IMPLEMENT
+#include <nanobench.h>
+
+#include <lexy/action/parse_as_tree.hpp>
+#include <lexy/action/validate.hpp>
+#include <lexy/input/buffer.hpp>
+#include <string>
+
+#define LEXY_TEST
+#include "../../examples/json.cpp"
+
+using input_t = lexy::buffer<lexy::utf8_encoding>;
+using tree_t  = lexy::parse_tree_for<input_t>;
+
+// The parse tree handler as it was before it was stripped of the nested validate handler.
+// It is only kept around to compare against.
+template <typename Tree, typename Input, typename ErrorCallback>
+class reference_parse_tree_handler
+{
+public:
+    explicit reference_parse_tree_handler(Tree& tree, const Input& input, const ErrorCallback& cb)
+    : _tree(&tree), _depth(0), _validate(input, cb)
+    {}
+
+    template <typename Production>
+    class event_handler
+    {
+        using iterator = typename lexy::input_reader<Input>::iterator;
+
+    public:
+        void on(reference_parse_tree_handler& handler, lexy::parse_events::production_start ev,
+                iterator pos)
+        {
+            if (handler._depth++ == 0)
+                handler._builder.emplace(LEXY_MOV(*handler._tree), Production{});
+            else
+                _marker = handler._builder->start_production(Production{});
+
+            _validate.on(handler._validate, ev, pos);
+        }
+
+        void on(reference_parse_tree_handler& handler, lexy::parse_events::production_finish ev,
+                iterator pos)
+        {
+            if (--handler._depth == 0)
+                *handler._tree = LEXY_MOV(*handler._builder).finish();
+            else
+                handler._builder->finish_production(LEXY_MOV(_marker));
+
+            _validate.on(handler._validate, ev, pos);
+        }
+
+        void on(reference_parse_tree_handler& handler, lexy::parse_events::production_cancel ev,
+                iterator pos)
+        {
+            if (--handler._depth == 0)
+                handler._tree->clear();
+            else
+            {
+                handler._builder->cancel_production(LEXY_MOV(_marker));
+                handler._builder->token(lexy::error_token_kind, _validate.production_begin(), pos);
+            }
+
+            _validate.on(handler._validate, ev, pos);
+        }
+
+        template <typename TokenKind>
+        void on(reference_parse_tree_handler& handler, lexy::parse_events::token ev,
+                TokenKind kind, iterator begin, iterator end)
+        {
+            handler._builder->token(kind, begin, end);
+            _validate.on(handler._validate, ev, kind, begin, end);
+        }
+
+        template <typename Event, typename... Args>
+        void on(reference_parse_tree_handler& handler, Event ev, Args&&... args)
+        {
+            _validate.on(handler._validate, ev, LEXY_FWD(args)...);
+        }
+
+    private:
+        typename Tree::builder::marker _marker;
+        typename lexy::validate_handler<Input, ErrorCallback>::template event_handler<Production>
+            _validate;
+    };
+
+    template <typename Production, typename State>
+    using value_callback = lexy::_detail::void_value_callback;
+
+    constexpr auto get_result_void(bool rule_parse_result) &&
+    {
+        return LEXY_MOV(_validate).get_result_void(rule_parse_result);
+    }
+
+private:
+    lexy::_detail::lazy_init<typename Tree::builder> _builder;
+    Tree*                                            _tree;
+    int                                              _depth;
+
+    lexy::validate_handler<Input, ErrorCallback> _validate;
+};
+
+bool tree_validate(const input_t& input)
+{
+    return lexy::validate<grammar::json>(input, lexy::noop).is_success();
+}
+
+bool tree_reference(tree_t& tree, const input_t& input)
+{
+    auto handler = reference_parse_tree_handler<tree_t, input_t, lexy::_noop>(tree, input,
+                                                                              lexy::noop);
+    auto reader  = input.reader();
+    return lexy::do_action<grammar::json>(LEXY_MOV(handler), lexy::no_parse_state, reader)
+        .is_success();
+}
+
+bool tree_lexy(tree_t& tree, const input_t& input)
+{
+    return lexy::parse_as_tree<grammar::json>(tree, input, lexy::noop).is_success();
+}
+
+bool tree_lexy_elided(tree_t& tree, const input_t& input)
+{
+    return lexy::parse_as_tree<grammar::json, lexy::whitespace_elided_parse_tree>(tree, input,
+                                                                                  lexy::noop)
+        .is_success();
+}
+
+// Generates a pretty-printed JSON document with the specified number of records.
+input_t generate_data(std::size_t records)
+{
+    std::string result = "[\n";
+    for (auto i = 0u; i != records; ++i)
+    {
+        auto id = std::to_string(i);
+        result += "  {\n";
+        result += "    \"id\": " + id + ",\n";
+        result += "    \"name\": \"record " + id + "\",\n";
+        result += "    \"active\": " + std::string(i % 2 == 0 ? "true" : "false") + ",\n";
+        result += "    \"position\": [" + id + ".5, -" + id + ".25]\n";
+        result += i + 1 == records ? "  }\n" : "  },\n";
+    }
+    result += "]\n";
+    return input_t(result.data(), result.size());
+}
+
+int main()
+{
+    ankerl::nanobench::Bench b;
+
+    auto bench_data = [&](const char* title, std::size_t records, std::size_t iterations) {
+        auto data = generate_data(records);
+
+        b.title(title).relative(true);
+        b.unit("byte").batch(data.size());
+        b.minEpochIterations(iterations);
+
+        tree_t tree;
+        b.run("validate", [&] { return tree_validate(data); });
+        b.run("reference parse_as_tree", [&] { return tree_reference(tree, data); });
+        b.run("parse_as_tree", [&] { return tree_lexy(tree, data); });
+        b.run("parse_as_tree (whitespace elided)", [&] { return tree_lexy_elided(tree, data); });
+    };
+
+    bench_data("10 records", 10, 10 * 1000);
+    bench_data("1000 records", 1000, 100);
+    bench_data("100000 records", 100 * 1000, 1);
+}
+
@@ -0,0 +1,100 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#define ANKERL_NANOBENCH_IMPLEMENT
+#include <nanobench.h>
+
+#include <cstdio>
+#include <fstream>
+#include <lexy/action/validate.hpp>
+#include <lexy/callback.hpp>
+#include <lexy/dsl.hpp>
+#include <lexy/input/file.hpp>
+#include <lexy_ext/validate_files.hpp>
+#include <string>
+#include <vector>
+
+namespace grammar
+{
+namespace dsl = lexy::dsl;
+
+// key = value
+struct entry
+{
+    static constexpr auto rule = [] {
+        auto ws    = dsl::whitespace(dsl::ascii::blank);
+        auto key   = dsl::identifier(dsl::ascii::alpha_underscore, dsl::ascii::alpha_digit_underscore);
+        auto value = dsl::identifier(dsl::ascii::alnum);
+        return key + ws + dsl::lit_c<'='> + ws + value + ws + dsl::newline;
+    }();
+};
+
+struct config
+{
+    static constexpr auto rule = dsl::terminator(dsl::eof).list(dsl::p<entry>);
+};
+} // namespace grammar
+
+std::vector<std::string> write_files(std::size_t count, std::size_t size)
+{
+    std::vector<std::string> paths;
+    for (auto i = 0u; i != count; ++i)
+    {
+        auto path = "bm-validate-files-" + std::to_string(i) + ".delete-me";
+
+        std::ofstream out(path, std::ios::binary);
+        for (auto written = std::size_t(0), line = std::size_t(0); written < size; ++line)
+        {
+            auto entry = "key_" + std::to_string(line) + " = value" + std::to_string(i) + "\n";
+            out << entry;
+            written += entry.size();
+        }
+
+        paths.push_back(LEXY_MOV(path));
+    }
+    return paths;
+}
+
+std::size_t validate_sequential(const std::vector<std::string>& paths)
+{
+    auto errors = std::size_t(0);
+    for (auto& path : paths)
+    {
+        auto file = lexy::read_file(path.c_str());
+        errors += lexy::validate<grammar::config>(file.buffer(), lexy::noop).error_count();
+    }
+    return errors;
+}
+
+std::size_t validate_parallel(lexy_ext::thread_pool& pool, const std::vector<std::string>& paths)
+{
+    auto errors = std::size_t(0);
+    for (auto& result : lexy_ext::validate_files<grammar::config>(paths, pool, lexy::noop))
+        errors += result.error_count();
+    return errors;
+}
+
+int main()
+{
+    ankerl::nanobench::Bench b;
+    lexy_ext::thread_pool    pool;
+
+    auto bench_data = [&](const char* title, std::size_t count, std::size_t size) {
+        b.minEpochIterations(10);
+        b.title(title).relative(true);
+        b.unit("file").batch(count);
+
+        auto paths = write_files(count, size);
+
+        b.run("sequential", [&] { return validate_sequential(paths); });
+        b.run("validate_files", [&] { return validate_parallel(pool, paths); });
+
+        for (auto& path : paths)
+            std::remove(path.c_str());
+    };
+
+    bench_data("1000 x 1 KiB", 1000, 1024);
+    bench_data("1000 x 16 KiB", 1000, 16 * 1024);
+    bench_data("100 x 1 MiB", 100, 1024 * 1024);
+}
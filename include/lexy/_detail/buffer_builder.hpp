@@ -11,11 +11,24 @@
 #include <lexy/_detail/iterator.hpp>
 #include <new>
 
+#if defined(__linux__) && !defined(LEXY_DISABLE_MREMAP)
+#    include <sys/mman.h>
+// Only declared if _GNU_SOURCE is defined, which is the default for C++.
+#    ifdef MREMAP_MAYMOVE
+#        define LEXY_HAS_MREMAP 1
+#    endif
+#endif
+#ifndef LEXY_HAS_MREMAP
+#    define LEXY_HAS_MREMAP 0
+#endif
+
 namespace lexy::_detail
 {
 // Builds a buffer: it has a read are and a write area.
 // The characters in the read area are already valid and can be read.
 // The characters in the write area are not valid, but can be written too.
+//
+// Big buffers are anonymous memory mappings on Linux, which grow in place using mremap().
 template <typename T>
 class buffer_builder
 {
@@ -23,20 +36,22 @@ class buffer_builder
 
     static constexpr std::size_t total_size_bytes = 1024;
     static constexpr std::size_t stack_buffer_size
-        = (total_size_bytes - 3 * sizeof(T*)) / sizeof(T);
+        = (total_size_bytes - 4 * sizeof(T*)) / sizeof(T);
     static constexpr auto growth_factor = 2;
 
 public:
-    buffer_builder() noexcept : _data(_stack_buffer), _read_size(0), _write_size(stack_buffer_size)
+    // Once the capacity reaches that many bytes, the memory is mapped instead of allocated.
+    static constexpr std::size_t mapping_threshold_bytes = std::size_t(16) * 1024 * 1024;
+
+    buffer_builder() noexcept
+    : _data(_stack_buffer), _read_size(0), _write_size(stack_buffer_size), _mapped(false)
     {
         static_assert(sizeof(*this) == total_size_bytes, "invalid buffer size calculation");
     }
 
     ~buffer_builder() noexcept
     {
-        // Free memory if we allocated any.
-        if (_data != _stack_buffer)
-            ::operator delete(_data);
+        _deallocate();
     }
 
     buffer_builder(const buffer_builder&) = delete;
@@ -68,6 +83,12 @@ public:
         return _write_size;
     }
 
+    // Whether the memory is an anonymous mapping that can be released using `release_mapping()`.
+    bool is_mapped() const noexcept
+    {
+        return _mapped;
+    }
+
     // Clears the read area.
     void clear() noexcept
     {
@@ -89,14 +110,48 @@ public:
         const auto cur_cap = capacity();
         const auto new_cap = growth_factor * cur_cap;
 
+#if LEXY_HAS_MREMAP
+        if (_mapped)
+        {
+            // The kernel moves the pages if necessary, we don't need to copy anything.
+            auto memory = ::mremap(_data, cur_cap * sizeof(T), new_cap * sizeof(T), MREMAP_MAYMOVE);
+            if (memory == MAP_FAILED) // NOLINT: int-to-ptr conversion happens in header
+                throw std::bad_alloc();
+
+            _data       = static_cast<T*>(memory);
+            _write_size = new_cap - _read_size;
+            return;
+        }
+        else if (new_cap * sizeof(T) >= mapping_threshold_bytes)
+        {
+            auto memory = ::mmap(nullptr, new_cap * sizeof(T), PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory != MAP_FAILED) // NOLINT: int-to-ptr conversion happens in header
+            {
+#    ifdef MADV_HUGEPAGE
+                // The hint is just an optimization, so we don't care whether it works.
+                ::madvise(memory, new_cap * sizeof(T), MADV_HUGEPAGE);
+#    endif
+                // This is the last time we copy the read area.
+                std::memcpy(memory, _data, _read_size * sizeof(T));
+                _deallocate();
+
+                _data       = static_cast<T*>(memory);
+                _write_size = new_cap - _read_size;
+                _mapped     = true;
+                return;
+            }
+            // If it fails, we try to allocate the memory normally.
+        }
+#endif
+
         // Allocate new memory.
         auto memory = static_cast<T*>(::operator new(new_cap * sizeof(T)));
         // Copy the read area into the new memory.
-        std::memcpy(memory, _data, _read_size);
+        std::memcpy(memory, _data, _read_size * sizeof(T));
 
         // Release the old memory, if there was any.
-        if (_data != _stack_buffer)
-            ::operator delete(_data);
+        _deallocate();
 
         // Update for the new area.
         _data = memory;
@@ -104,6 +159,35 @@ public:
         _write_size = new_cap - _read_size;
     }
 
+    // Transfers ownership of the mapped memory to the caller, who has to unmap it.
+    // The mapping is resized to exactly `size` bytes first, which must cover the read area.
+    // Afterwards, the builder is empty again.
+    T* release_mapping(std::size_t size)
+    {
+        LEXY_PRECONDITION(_mapped);
+        LEXY_PRECONDITION(size >= _read_size * sizeof(T));
+
+        auto result = _data;
+#if LEXY_HAS_MREMAP
+        if (size != capacity() * sizeof(T))
+        {
+            // Shrinking happens in place, growing might move the pages.
+            auto memory = ::mremap(_data, capacity() * sizeof(T), size, MREMAP_MAYMOVE);
+            if (memory == MAP_FAILED) // NOLINT: int-to-ptr conversion happens in header
+                throw std::bad_alloc();
+            result = static_cast<T*>(memory);
+        }
+#else
+        (void)size;
+#endif
+
+        _data       = _stack_buffer;
+        _read_size  = 0;
+        _write_size = stack_buffer_size;
+        _mapped     = false;
+        return result;
+    }
+
     //=== iterator ===//
     // Stable iterator over the memory.
     class stable_iterator : public forward_iterator_base<stable_iterator, const T>
@@ -150,9 +234,26 @@ public:
     };
 
 private:
+    void _deallocate() noexcept
+    {
+#if LEXY_HAS_MREMAP
+        if (_mapped)
+        {
+            ::munmap(_data, capacity() * sizeof(T));
+            _mapped = false;
+            return;
+        }
+#endif
+
+        // Free memory if we allocated any.
+        if (_data != _stack_buffer)
+            ::operator delete(_data);
+    }
+
     T*          _data;
     std::size_t _read_size;
     std::size_t _write_size;
+    bool        _mapped;
     T           _stack_buffer[stack_buffer_size];
 };
 } // namespace lexy::_detail
@@ -0,0 +1,201 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef LEXY_ACTION_ACCUMULATING_PARSE_HPP_INCLUDED
+#define LEXY_ACTION_ACCUMULATING_PARSE_HPP_INCLUDED
+
+#include <lexy/_detail/buffer_builder.hpp>
+#include <lexy/action/parse.hpp>
+#include <lexy/action/validate.hpp>
+#include <lexy/callback/noop.hpp>
+#include <lexy/input/string_input.hpp>
+
+namespace lexy
+{
+// A reader that remembers whether it has looked at the end of the available data.
+template <typename Encoding>
+class _accumulating_reader
+{
+public:
+    using encoding = Encoding;
+    using iterator = const typename Encoding::char_type*;
+
+    constexpr explicit _accumulating_reader(iterator begin, iterator end,
+                                            bool* end_reached) noexcept
+    : _cur(begin), _end(end), _end_reached(end_reached)
+    {}
+
+    constexpr auto peek() const noexcept
+    {
+        if (_cur == _end)
+        {
+            *_end_reached = true;
+            return encoding::eof();
+        }
+        else
+            return encoding::to_int_type(*_cur);
+    }
+
+    constexpr void bump() noexcept
+    {
+        LEXY_PRECONDITION(_cur != _end);
+        ++_cur;
+    }
+
+    constexpr iterator position() const noexcept
+    {
+        return _cur;
+    }
+
+    constexpr void set_position(iterator new_pos) noexcept
+    {
+        LEXY_PRECONDITION(new_pos <= _end);
+        _cur = new_pos;
+    }
+
+private:
+    iterator _cur;
+    iterator _end;
+    bool*    _end_reached;
+};
+
+template <typename Encoding>
+class _accumulating_input
+{
+public:
+    using encoding  = Encoding;
+    using char_type = typename encoding::char_type;
+
+    constexpr explicit _accumulating_input(const char_type* data, std::size_t size,
+                                           bool* end_reached) noexcept
+    : _data(data), _size(size), _end_reached(end_reached)
+    {}
+
+    constexpr auto reader() const& noexcept
+    {
+        return _accumulating_reader<encoding>(_data, _data + _size, _end_reached);
+    }
+
+private:
+    const char_type* _data;
+    std::size_t      _size;
+    bool*            _end_reached;
+};
+
+enum class accumulate_status
+{
+    /// The data fed so far is not enough to decide the result.
+    need_more,
+    /// The production matches; data fed afterwards does not change the result.
+    complete,
+    /// The production does not match; data fed afterwards does not change the result.
+    failed,
+};
+
+/// Accumulates input that arrives in pieces and tells when it is enough to parse a production.
+///
+/// It does not suspend the parse when it runs out of data:
+/// lexy's rules are templates that call the next parser directly,
+/// so there is no explicit state that could be saved and resumed.
+/// Instead, the production is validated again from the beginning on all data fed so far, until
+/// the result no longer depends on data that has not arrived yet.
+/// To keep this linear, `feed()` only does so once the data has doubled since the last attempt;
+/// `check()` does it right away.
+template <typename Production, typename Encoding = default_encoding>
+class accumulating_parser
+{
+public:
+    using encoding   = Encoding;
+    using char_type  = typename encoding::char_type;
+    using input_type = string_input<encoding>;
+
+    accumulating_parser() noexcept : _checked_size(0), _status(accumulate_status::need_more) {}
+
+    accumulating_parser(const accumulating_parser&) = delete;
+    accumulating_parser& operator=(const accumulating_parser&) = delete;
+
+    //=== feed ===//
+    /// Appends the data and checks whether the result is already known,
+    /// if there is at least as much new data as the last check looked at.
+    accumulate_status feed(const char_type* data, std::size_t size)
+    {
+        while (_buffer.write_size() < size)
+            _buffer.grow();
+        std::memcpy(_buffer.write_data(), data, size * sizeof(char_type));
+        _buffer.commit(size);
+
+        if (_buffer.read_size() - _checked_size >= _checked_size)
+            return check();
+        else
+            return _status;
+    }
+
+    /// Checks whether the result is already known.
+    ///
+    /// Call it once no more data is available for now, e.g. before waiting for the next piece.
+    accumulate_status check()
+    {
+        // The previous check looked at the end of the data, so it is only worth repeating once
+        // there is new data.
+        if (_status == accumulate_status::need_more && _buffer.read_size() > _checked_size)
+        {
+            // If validating never looked at the end of the data, the parser has not noticed that
+            // there might be more of it, and the same thing happens when parsing all of it.
+            auto end_reached = false;
+            auto input       = _accumulating_input<encoding>(_buffer.read_data(),
+                                                           _buffer.read_size(), &end_reached);
+            auto result      = lexy::validate<Production>(input, lexy::noop);
+            if (!end_reached)
+                _status = result ? accumulate_status::complete : accumulate_status::failed;
+
+            _checked_size = _buffer.read_size();
+        }
+
+        return _status;
+    }
+
+    accumulate_status status() const noexcept
+    {
+        return _status;
+    }
+
+    /// Discards all data to start parsing a new input.
+    void reset() noexcept
+    {
+        _buffer.clear();
+        _checked_size = 0;
+        _status       = accumulate_status::need_more;
+    }
+
+    //=== finish ===//
+    /// The data fed so far.
+    input_type input() const noexcept
+    {
+        return input_type(_buffer.read_data(), _buffer.read_size());
+    }
+
+    /// Parses the production on all data fed so far.
+    ///
+    /// The result is the same as `lexy::parse()` on `input()`, which must be kept alive as long
+    /// as the result refers to it, i.e. the parser must not be fed, reset or destroyed.
+    template <typename Callback>
+    auto finish(Callback callback) const
+    {
+        return lexy::parse<Production>(input(), LEXY_MOV(callback));
+    }
+    template <typename State, typename Callback>
+    auto finish(const State& state, Callback callback) const
+    {
+        return lexy::parse<Production>(input(), state, LEXY_MOV(callback));
+    }
+
+private:
+    // Not a lexy::buffer, as it is neither growable nor do we want the sentinel.
+    _detail::buffer_builder<char_type> _buffer;
+    std::size_t                        _checked_size;
+    accumulate_status                  _status;
+};
+} // namespace lexy
+
+#endif // LEXY_ACTION_ACCUMULATING_PARSE_HPP_INCLUDED
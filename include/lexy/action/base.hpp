@@ -161,14 +161,17 @@ namespace lexy
 {
 constexpr void* no_parse_state = nullptr;
 
-template <typename Production, typename Handler, typename State, typename Reader>
+// RootProduction is only different from Production if we're resuming parsing of a production that
+// was nested inside RootProduction, e.g. for a deferred production.
+template <typename Production, typename RootProduction = Production, typename Handler,
+          typename State, typename Reader>
 constexpr auto do_action(Handler&& handler, const State* state, Reader& reader)
 {
     static_assert(!std::is_reference_v<Handler>, "need to move handler in");
 
     _detail::parse_context_control_block control_block(LEXY_MOV(handler), state,
-                                                       max_recursion_depth<Production>());
-    _pc<Handler, State, Production>      context(&control_block);
+                                                       max_recursion_depth<RootProduction>());
+    _pc<Handler, State, Production, RootProduction> context(&control_block);
 
     context.on(parse_events::production_start{}, reader.position());
 
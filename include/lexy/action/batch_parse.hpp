@@ -0,0 +1,244 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef LEXY_ACTION_BATCH_PARSE_HPP_INCLUDED
+#define LEXY_ACTION_BATCH_PARSE_HPP_INCLUDED
+
+#include <lexy/action/base.hpp>
+#include <lexy/callback/base.hpp>
+#include <lexy/callback/noop.hpp>
+#include <lexy/error.hpp>
+#include <vector>
+
+namespace lexy
+{
+template <typename T, typename Error>
+class batch_parse_result
+{
+public:
+    using value_type = T;
+    using error_type = Error;
+
+    //=== status ===//
+    constexpr explicit operator bool() const noexcept
+    {
+        return is_success();
+    }
+
+    constexpr bool is_success() const noexcept
+    {
+        return _error_count == 0;
+    }
+    constexpr bool is_error() const noexcept
+    {
+        return !is_success();
+    }
+    constexpr bool is_recovered_error() const noexcept
+    {
+        return is_error() && _rule_parse_result;
+    }
+    constexpr bool is_fatal_error() const noexcept
+    {
+        return is_error() && !_rule_parse_result;
+    }
+
+    //=== value ===//
+    constexpr bool has_value() const noexcept
+    {
+        return static_cast<bool>(_value);
+    }
+
+    constexpr const auto& value() const& noexcept
+    {
+        return *_value;
+    }
+    constexpr auto&& value() && noexcept
+    {
+        return LEXY_MOV(*_value);
+    }
+
+    //=== error ===//
+    constexpr std::size_t error_count() const noexcept
+    {
+        return _error_count;
+    }
+
+    /// The errors, they are owned by the `batch_parser` and only valid until its next parse.
+    template <typename E = Error, typename = std::enable_if_t<!std::is_void_v<E>>>
+    constexpr const std::vector<E>& errors() const noexcept
+    {
+        return *_errors;
+    }
+
+private:
+    using _error_storage = std::conditional_t<std::is_void_v<Error>, void, std::vector<Error>>;
+
+    constexpr explicit batch_parse_result(bool rule_parse_result, std::size_t error_count,
+                                          const _error_storage* errors) noexcept
+    : _value(), _errors(errors), _error_count(error_count), _rule_parse_result(rule_parse_result)
+    {}
+    template <typename U>
+    constexpr explicit batch_parse_result(bool rule_parse_result, std::size_t error_count,
+                                          const _error_storage* errors, U&& value) noexcept
+    : batch_parse_result(rule_parse_result, error_count, errors)
+    {
+        _value.emplace(LEXY_FWD(value));
+    }
+
+    lexy::_detail::lazy_init<T> _value;
+    const _error_storage*       _errors;
+    std::size_t                 _error_count;
+    bool                        _rule_parse_result;
+
+    template <typename Production, typename Input, typename ErrorCallback, typename State>
+    friend class batch_parser;
+};
+
+template <typename State>
+using _detect_resource_reset = decltype(LEXY_DECLVAL(const State&).memory_resource()->reset());
+
+/// Parses many inputs with the same production.
+///
+/// The errors are stored in a container owned by the parser, which is cleared but not deallocated
+/// between two parses, so parsing many small inputs does not allocate for the errors again.
+/// Likewise, if the parse state has a memory resource that can be reset, e.g. an arena from
+/// `lexy::with_arena()`, it is reset at the beginning of each parse.
+template <typename Production, typename Input,
+          typename ErrorCallback = LEXY_DECAY_DECLTYPE(lexy::noop), typename State = void>
+class batch_parser
+{
+    static_assert(std::is_same_v<ErrorCallback, lexy::_noop> || !lexy::is_sink<ErrorCallback>,
+                  "batch_parser requires a callback that is invoked for each error");
+
+    using _error_t = typename ErrorCallback::return_type;
+    using _storage = std::conditional_t<std::is_void_v<_error_t>, void, std::vector<_error_t>>;
+    using _value_t = typename production_value_callback<Production, State>::return_type;
+
+public:
+    using result_type = batch_parse_result<_value_t, _error_t>;
+
+    template <typename S = State, typename = std::enable_if_t<std::is_void_v<S>>>
+    constexpr batch_parser() : _callback(), _errors(), _state(nullptr), _error_count(0) {}
+    template <typename S = State, typename = std::enable_if_t<std::is_void_v<S>>>
+    constexpr explicit batch_parser(ErrorCallback callback)
+    : _callback(LEXY_MOV(callback)), _errors(), _state(nullptr), _error_count(0)
+    {}
+
+    /// Uses the parse state for all parses, it must outlive the parser.
+    template <typename S, typename = std::enable_if_t<std::is_same_v<S, State>>>
+    constexpr explicit batch_parser(const S& state, ErrorCallback callback = ErrorCallback())
+    : _callback(LEXY_MOV(callback)), _errors(), _state(&state), _error_count(0)
+    {}
+
+    /// Parses the production on the input.
+    /// The errors of the previous result are discarded;
+    /// if the memory resource of the parse state is reset, its value is invalidated as well.
+    result_type parse(const Input& input)
+    {
+        if constexpr (!std::is_void_v<_error_t>)
+            _errors.clear();
+        _error_count = 0;
+
+        if constexpr (lexy::_detail::is_detected<_detect_resource_reset, State>)
+            _state->memory_resource()->reset();
+
+        auto reader = input.reader();
+        return lexy::do_action<Production>(_handler(*this, input), _state, reader);
+    }
+
+private:
+    class _handler
+    {
+        using iterator = typename lexy::input_reader<Input>::iterator;
+
+    public:
+        constexpr explicit _handler(batch_parser& parser, const Input& input)
+        : _parser(&parser), _input(&input)
+        {}
+
+        template <typename P>
+        class event_handler
+        {
+        public:
+            constexpr event_handler() = default;
+
+            constexpr void on(_handler&, parse_events::production_start, iterator pos)
+            {
+                _begin = pos;
+            }
+
+            template <typename Error>
+            constexpr void on(_handler& handler, parse_events::error, Error&& error)
+            {
+                auto& parser = *handler._parser;
+                ++parser._error_count;
+
+                if constexpr (std::is_same_v<ErrorCallback, lexy::_noop>)
+                {
+                    // The errors are only counted, so we don't need to build an error context.
+                    (void)error;
+                }
+                else
+                {
+                    lexy::error_context err_ctx(P{}, *handler._input, _begin);
+                    if constexpr (std::is_void_v<_error_t>)
+                        parser._callback(err_ctx, LEXY_FWD(error));
+                    else
+                        parser._errors.push_back(parser._callback(err_ctx, LEXY_FWD(error)));
+                }
+            }
+
+            template <typename Event, typename... Args>
+            constexpr void on(_handler&, Event, const Args&...)
+            {}
+
+        private:
+            iterator _begin = {};
+        };
+
+        template <typename P, typename S>
+        using value_callback = production_value_callback<P, S>;
+
+        constexpr auto get_result_void(bool rule_parse_result) &&
+        {
+            return result_type(rule_parse_result, _parser->_error_count, _parser->_error_storage());
+        }
+
+        template <typename T>
+        constexpr auto get_result(bool rule_parse_result, T&& result) &&
+        {
+            return result_type(rule_parse_result, _parser->_error_count,
+                               _parser->_error_storage(), LEXY_MOV(result));
+        }
+        template <typename T>
+        constexpr auto get_result(bool rule_parse_result) &&
+        {
+            return result_type(rule_parse_result, _parser->_error_count,
+                               _parser->_error_storage());
+        }
+
+    private:
+        batch_parser* _parser;
+        const Input*  _input;
+    };
+
+    constexpr const _storage* _error_storage() const noexcept
+    {
+        if constexpr (std::is_void_v<_error_t>)
+            return nullptr;
+        else
+            return &_errors;
+    }
+
+    struct _no_storage
+    {};
+
+    LEXY_EMPTY_MEMBER ErrorCallback _callback;
+    LEXY_EMPTY_MEMBER std::conditional_t<std::is_void_v<_error_t>, _no_storage, _storage> _errors;
+    const State*                                                                        _state;
+    std::size_t                                                                         _error_count;
+};
+} // namespace lexy
+
+#endif // LEXY_ACTION_BATCH_PARSE_HPP_INCLUDED
@@ -5,18 +5,85 @@
 #ifndef LEXY_ACTION_PARSE_AS_TREE_HPP_INCLUDED
 #define LEXY_ACTION_PARSE_AS_TREE_HPP_INCLUDED
 
+#include <lexy/_detail/detect.hpp>
 #include <lexy/action/base.hpp>
 #include <lexy/action/validate.hpp>
 #include <lexy/parse_tree.hpp>
 
 namespace lexy
 {
-template <typename Tree, typename Input, typename ErrorCallback>
+/// Parse tree policy that adds every token to the tree, so the tree is lossless.
+struct lossless_parse_tree
+{
+    template <typename TokenKind>
+    static constexpr bool keep_token(token_kind<TokenKind>) noexcept
+    {
+        return true;
+    }
+};
+
+/// Parse tree policy that does not add whitespace tokens to the tree.
+/// The whitespace is still implied by the gap between two adjacent tokens.
+struct whitespace_elided_parse_tree
+{
+    template <typename TokenKind>
+    static constexpr bool keep_token(token_kind<TokenKind> kind) noexcept
+    {
+        return kind != lexy::whitespace_token_kind;
+    }
+};
+
+/// Parse tree policy that skips over productions that provide a `deferred` token rule.
+/// Their node only contains a single token that covers everything the production would have
+/// consumed; the content can be parsed later on.
+struct deferred_parse_tree
+{
+    template <typename TokenKind>
+    static constexpr bool keep_token(token_kind<TokenKind>) noexcept
+    {
+        return true;
+    }
+
+    template <typename Production>
+    using _detect_deferred = decltype(Production::deferred);
+
+    template <typename Production>
+    static constexpr bool defer_production
+        = lexy::_detail::is_detected<_detect_deferred, Production>
+          && !lexy::is_transparent_production<Production>;
+};
+
+template <typename Tree, typename Input, typename ErrorCallback,
+          typename Policy = lossless_parse_tree>
 class parse_tree_handler
 {
+    template <typename Reader, typename TokenKind, typename MemoryResource, typename Kind>
+    static constexpr auto _token_kind_of(const parse_tree<Reader, TokenKind, MemoryResource>*,
+                                         Kind kind)
+    {
+        return token_kind<TokenKind>(kind);
+    }
+    template <typename Kind>
+    static constexpr auto _token_kind(Kind kind)
+    {
+        return _token_kind_of(static_cast<const Tree*>(nullptr), kind);
+    }
+
+    template <typename P, typename Production>
+    using _detect_defer_production = decltype(P::template defer_production<Production>);
+
 public:
+    /// Whether the policy skips over the production, see `lexy::deferred_parse_tree`.
+    template <typename Production>
+    static constexpr bool defer_production = [] {
+        if constexpr (lexy::_detail::is_detected<_detect_defer_production, Policy, Production>)
+            return Policy::template defer_production<Production>;
+        else
+            return false;
+    }();
+
     explicit parse_tree_handler(Tree& tree, const Input& input, const ErrorCallback& cb)
-    : _tree(&tree), _depth(0), _validate(input, cb)
+    : _tree(&tree), _depth(0), _sink(_get_error_sink(cb)), _input(&input)
     {}
 
     template <typename Production>
@@ -25,27 +92,25 @@ public:
         using iterator = typename lexy::input_reader<Input>::iterator;
 
     public:
-        void on(parse_tree_handler& handler, parse_events::production_start ev, iterator pos)
+        void on(parse_tree_handler& handler, parse_events::production_start, iterator pos)
         {
             if (handler._depth++ == 0)
                 handler._builder.emplace(LEXY_MOV(*handler._tree), Production{});
             else
                 _marker = handler._builder->start_production(Production{});
 
-            _validate.on(handler._validate, ev, pos);
+            _begin = pos;
         }
 
-        void on(parse_tree_handler& handler, parse_events::production_finish ev, iterator pos)
+        void on(parse_tree_handler& handler, parse_events::production_finish, iterator)
         {
             if (--handler._depth == 0)
                 *handler._tree = LEXY_MOV(*handler._builder).finish();
             else
                 handler._builder->finish_production(LEXY_MOV(_marker));
-
-            _validate.on(handler._validate, ev, pos);
         }
 
-        void on(parse_tree_handler& handler, parse_events::production_cancel ev, iterator pos)
+        void on(parse_tree_handler& handler, parse_events::production_cancel, iterator pos)
         {
             if (--handler._depth == 0)
                 handler._tree->clear();
@@ -55,36 +120,41 @@ public:
                 // To ensure that the parse tree remains lossless, we add everything consumed by it
                 // as an error token.
                 handler._builder->cancel_production(LEXY_MOV(_marker));
-                handler._builder->token(lexy::error_token_kind, _validate.production_begin(), pos);
+                handler._builder->token(lexy::error_token_kind, _begin, pos);
             }
-
-            _validate.on(handler._validate, ev, pos);
         }
 
         template <typename TokenKind>
-        void on(parse_tree_handler& handler, parse_events::token ev, TokenKind kind, iterator begin,
+        void on(parse_tree_handler& handler, parse_events::token, TokenKind kind, iterator begin,
                 iterator end)
         {
-            handler._builder->token(kind, begin, end);
-            _validate.on(handler._validate, ev, kind, begin, end);
+            if (Policy::keep_token(_token_kind(kind)))
+                handler._builder->token(kind, begin, end);
         }
 
         template <typename Error>
-        void on(parse_tree_handler& handler, parse_events::error ev, Error&& error)
+        void on(parse_tree_handler& handler, parse_events::error, Error&& error)
         {
-            _validate.on(handler._validate, ev, LEXY_FWD(error));
+            if constexpr (std::is_same_v<ErrorCallback, lexy::_noop>)
+            {
+                // The errors are only counted, so we don't need to build an error context.
+                (void)error;
+                handler._sink();
+            }
+            else
+            {
+                lexy::error_context err_ctx(Production{}, *handler._input, _begin);
+                handler._sink(err_ctx, LEXY_FWD(error));
+            }
         }
 
         template <typename Event, typename... Args>
-        void on(parse_tree_handler& handler, Event ev, Args&&... args)
-        {
-            _validate.on(handler._validate, ev, LEXY_FWD(args)...);
-        }
+        void on(parse_tree_handler&, Event, const Args&...)
+        {}
 
     private:
         typename Tree::builder::marker _marker;
-        typename validate_handler<Input, ErrorCallback>::template event_handler<Production>
-            _validate;
+        iterator                       _begin = {};
     };
 
     template <typename Production, typename State>
@@ -92,7 +162,7 @@ public:
 
     constexpr auto get_result_void(bool rule_parse_result) &&
     {
-        return LEXY_MOV(_validate).get_result_void(rule_parse_result);
+        return validate_result<ErrorCallback>(rule_parse_result, LEXY_MOV(_sink).finish());
     }
 
 private:
@@ -100,28 +170,33 @@ private:
     Tree*                                            _tree;
     int                                              _depth;
 
-    validate_handler<Input, ErrorCallback> _validate;
+    _error_sink_t<ErrorCallback> _sink;
+    const Input*                 _input;
 };
 
-template <typename Production, typename TokenKind, typename MemoryResource, typename Input,
-          typename ErrorCallback>
+template <typename Production, typename Policy = lossless_parse_tree, typename TokenKind,
+          typename MemoryResource, typename Input, typename ErrorCallback>
 auto parse_as_tree(parse_tree<lexy::input_reader<Input>, TokenKind, MemoryResource>& tree,
                    const Input& input, const ErrorCallback& callback)
     -> validate_result<ErrorCallback>
 {
-    auto handler = parse_tree_handler(tree, input, LEXY_MOV(callback));
-    auto reader  = input.reader();
+    using tree_t = parse_tree<lexy::input_reader<Input>, TokenKind, MemoryResource>;
+    auto handler = parse_tree_handler<tree_t, Input, ErrorCallback, Policy>(tree, input, callback);
+
+    auto reader = input.reader();
     return lexy::do_action<Production>(LEXY_MOV(handler), no_parse_state, reader);
 }
 
-template <typename Production, typename TokenKind, typename MemoryResource, typename Input,
-          typename State, typename ErrorCallback>
+template <typename Production, typename Policy = lossless_parse_tree, typename TokenKind,
+          typename MemoryResource, typename Input, typename State, typename ErrorCallback>
 auto parse_as_tree(parse_tree<lexy::input_reader<Input>, TokenKind, MemoryResource>& tree,
                    const Input& input, const State& state, const ErrorCallback& callback)
     -> validate_result<ErrorCallback>
 {
-    auto handler = parse_tree_handler(tree, input, LEXY_MOV(callback));
-    auto reader  = input.reader();
+    using tree_t = parse_tree<lexy::input_reader<Input>, TokenKind, MemoryResource>;
+    auto handler = parse_tree_handler<tree_t, Input, ErrorCallback, Policy>(tree, input, callback);
+
+    auto reader = input.reader();
     return lexy::do_action<Production>(LEXY_MOV(handler), &state, reader);
 }
 } // namespace lexy
@@ -114,6 +114,8 @@ private:
 
     template <typename Input, typename Callback>
     friend class validate_handler;
+    template <typename Tree, typename Input, typename Callback, typename Policy>
+    friend class parse_tree_handler;
 };
 } // namespace lexy
 
@@ -0,0 +1,422 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef LEXY_AST_HPP_INCLUDED
+#define LEXY_AST_HPP_INCLUDED
+
+#include <cstdint>
+#include <lexy/_detail/assert.hpp>
+#include <lexy/_detail/config.hpp>
+#include <lexy/_detail/iterator.hpp>
+#include <lexy/encoding.hpp>
+#include <lexy/input/string_input.hpp>
+#include <lexy/lexeme.hpp>
+#include <lexy/memory_resource.hpp>
+#include <vector>
+
+namespace lexy
+{
+struct nullopt;
+
+/// The index of a node in a `lexy::flat_ast`, or null.
+class ast_node_id
+{
+public:
+    constexpr ast_node_id() noexcept : _value(UINT32_MAX) {}
+    constexpr explicit ast_node_id(std::uint32_t value) noexcept : _value(value) {}
+
+    /// Whether it refers to a node.
+    constexpr explicit operator bool() const noexcept
+    {
+        return _value != UINT32_MAX;
+    }
+
+    constexpr std::uint32_t value() const noexcept
+    {
+        return _value;
+    }
+
+    friend constexpr bool operator==(ast_node_id lhs, ast_node_id rhs) noexcept
+    {
+        return lhs._value == rhs._value;
+    }
+    friend constexpr bool operator!=(ast_node_id lhs, ast_node_id rhs) noexcept
+    {
+        return lhs._value != rhs._value;
+    }
+
+private:
+    std::uint32_t _value;
+};
+
+/// An AST whose nodes are stored in flat arrays and refer to each other by index.
+///
+/// Each node has a kind, an optional text, and a list of children.
+/// Children are created before their parent, so the last node is the root.
+template <typename Kind, typename Encoding = default_encoding, typename MemoryResource = void>
+class flat_ast
+{
+    template <typename T>
+    using _array = std::vector<T, resource_allocator<T, MemoryResource>>;
+
+public:
+    using kind_type = Kind;
+    using encoding  = Encoding;
+    using char_type = typename encoding::char_type;
+
+    explicit flat_ast(MemoryResource* resource = _detail::get_memory_resource<MemoryResource>())
+    : _kinds(resource), _first_child(resource), _next_sibling(resource), _text_begin(resource),
+      _text_size(resource), _text(resource)
+    {}
+
+    //=== access ===//
+    bool empty() const noexcept
+    {
+        return _kinds.empty();
+    }
+
+    /// The number of nodes.
+    std::size_t size() const noexcept
+    {
+        return _kinds.size();
+    }
+
+    /// The node that was created last.
+    ast_node_id root() const noexcept
+    {
+        LEXY_PRECONDITION(!empty());
+        return ast_node_id(std::uint32_t(size() - 1));
+    }
+
+    Kind kind(ast_node_id node) const noexcept
+    {
+        return _kinds[_idx(node)];
+    }
+
+    /// The text of the node; it is invalidated when nodes are added.
+    string_lexeme<Encoding> text(ast_node_id node) const noexcept
+    {
+        auto idx = _idx(node);
+        return string_lexeme<Encoding>(_text.data() + _text_begin[idx], _text_size[idx]);
+    }
+
+    ast_node_id first_child(ast_node_id node) const noexcept
+    {
+        return _first_child[_idx(node)];
+    }
+    ast_node_id next_sibling(ast_node_id node) const noexcept
+    {
+        return _next_sibling[_idx(node)];
+    }
+
+    class children_range
+    {
+    public:
+        class iterator
+        : public _detail::forward_iterator_base<iterator, ast_node_id, ast_node_id, void>
+        {
+        public:
+            iterator() noexcept : _ast(nullptr), _cur() {}
+
+            ast_node_id deref() const noexcept
+            {
+                return _cur;
+            }
+
+            void increment() noexcept
+            {
+                _cur = _ast->next_sibling(_cur);
+            }
+
+            bool equal(iterator rhs) const noexcept
+            {
+                return _cur == rhs._cur;
+            }
+
+        private:
+            explicit iterator(const flat_ast* ast, ast_node_id cur) noexcept : _ast(ast), _cur(cur)
+            {}
+
+            const flat_ast* _ast;
+            ast_node_id     _cur;
+
+            friend children_range;
+        };
+
+        bool empty() const noexcept
+        {
+            return !_first;
+        }
+
+        iterator begin() const noexcept
+        {
+            return iterator(_ast, _first);
+        }
+        iterator end() const noexcept
+        {
+            return iterator(_ast, ast_node_id());
+        }
+
+    private:
+        explicit children_range(const flat_ast* ast, ast_node_id first) noexcept
+        : _ast(ast), _first(first)
+        {}
+
+        const flat_ast* _ast;
+        ast_node_id     _first;
+
+        friend flat_ast;
+    };
+
+    children_range children(ast_node_id node) const noexcept
+    {
+        return children_range(this, first_child(node));
+    }
+
+    //=== modifiers ===//
+    /// Destroys all nodes, but keeps the memory.
+    void clear() noexcept
+    {
+        _kinds.clear();
+        _first_child.clear();
+        _next_sibling.clear();
+        _text_begin.clear();
+        _text_size.clear();
+        _text.clear();
+    }
+
+    /// Creates a new node whose children start at `first_child` and are linked using
+    /// `link_siblings()`.
+    ast_node_id create_node(Kind kind, ast_node_id first_child = {})
+    {
+        LEXY_PRECONDITION(size() < UINT32_MAX);
+        _kinds.push_back(kind);
+        _first_child.push_back(first_child);
+        _next_sibling.push_back(ast_node_id());
+        _text_begin.push_back(std::uint32_t(_text.size()));
+        _text_size.push_back(0);
+        return ast_node_id(std::uint32_t(size() - 1));
+    }
+
+    /// Makes `next` the next sibling of `prev`.
+    void link_siblings(ast_node_id prev, ast_node_id next) noexcept
+    {
+        _next_sibling[_idx(prev)] = next;
+    }
+
+    /// Copies the text into the AST and sets it as the text of the node.
+    template <typename Iterator>
+    void set_text(ast_node_id node, Iterator begin, Iterator end)
+    {
+        auto idx         = _idx(node);
+        _text_begin[idx] = std::uint32_t(_text.size());
+        _text.insert(_text.end(), begin, end);
+        _text_size[idx] = std::uint32_t(_text.size() - _text_begin[idx]);
+    }
+
+private:
+    std::size_t _idx(ast_node_id node) const noexcept
+    {
+        LEXY_PRECONDITION(node && node.value() < size());
+        return node.value();
+    }
+
+    _array<Kind>          _kinds;
+    _array<ast_node_id>   _first_child;
+    _array<ast_node_id>   _next_sibling;
+    _array<std::uint32_t> _text_begin;
+    _array<std::uint32_t> _text_size;
+    _array<char_type>     _text;
+};
+
+/// A parse state that makes the AST available to `lexy::ast_node` and `lexy::ast_children`.
+template <typename Ast>
+class ast_builder
+{
+public:
+    constexpr explicit ast_builder(Ast& ast) noexcept : _ast(&ast) {}
+
+    constexpr Ast& ast() const noexcept
+    {
+        return *_ast;
+    }
+
+private:
+    Ast* _ast;
+};
+} // namespace lexy
+
+namespace lexy
+{
+template <typename State>
+using _detect_ast_builder = std::remove_reference_t<decltype(LEXY_DECLVAL(const State&).ast())>;
+
+template <typename T>
+constexpr bool _is_ast_arg = std::is_same_v<T, ast_node_id> || std::is_same_v<T, nullopt>;
+template <typename Reader>
+constexpr bool _is_ast_arg<lexeme<Reader>> = true;
+
+template <typename T>
+constexpr bool _is_ast_lexeme = false;
+template <typename Reader>
+constexpr bool _is_ast_lexeme<lexeme<Reader>> = true;
+
+template <typename Ast, auto Kind>
+struct _ast_node_cb
+{
+    static_assert(std::is_same_v<typename Ast::kind_type, decltype(Kind)>,
+                  "node kind does not match the kind of the AST");
+
+    Ast* _ast;
+
+    using return_type = ast_node_id;
+
+    template <typename... Args>
+    auto operator()(Args&&... args) const
+        -> std::enable_if_t<(_is_ast_arg<std::decay_t<Args>> && ...), ast_node_id>
+    {
+        static_assert((_is_ast_lexeme<std::decay_t<Args>> + ... + 0) <= 1,
+                      "a node can only have a single lexeme as text");
+
+        // Link all children.
+        ast_node_id first, last;
+        (_link(first, last, args), ...);
+
+        auto node = _ast->create_node(Kind, first);
+        (_set_text(node, args), ...);
+        return node;
+    }
+
+    void _link(ast_node_id& first, ast_node_id& last, ast_node_id child) const
+    {
+        if (!first)
+            first = child;
+        else
+            _ast->link_siblings(last, child);
+        last = child;
+    }
+    template <typename Arg>
+    void _link(ast_node_id&, ast_node_id&, const Arg&) const
+    {}
+
+    template <typename Reader>
+    void _set_text(ast_node_id node, const lexeme<Reader>& lex) const
+    {
+        _ast->set_text(node, lex.begin(), lex.end());
+    }
+    template <typename Arg>
+    void _set_text(ast_node_id, const Arg&) const
+    {}
+};
+
+template <typename Ast, auto Kind>
+class _ast_children_sink
+{
+public:
+    using return_type = ast_node_id;
+
+    constexpr explicit _ast_children_sink(Ast* ast) noexcept : _ast(ast), _first(), _last() {}
+
+    void operator()(ast_node_id child)
+    {
+        if (!_first)
+            _first = child;
+        else
+            _ast->link_siblings(_last, child);
+        _last = child;
+    }
+    void operator()(nullopt&&) {}
+
+    ast_node_id finish() &&
+    {
+        return _ast->create_node(Kind, _first);
+    }
+
+private:
+    Ast*        _ast;
+    ast_node_id _first, _last;
+};
+
+template <auto Kind>
+struct _ast_node
+{
+    using return_type = ast_node_id;
+
+    // Only provided so the callback is detected; the parse state is required.
+    template <typename... Args>
+    auto operator()(Args&&...) const
+        -> std::enable_if_t<(_is_ast_arg<std::decay_t<Args>> && ...), ast_node_id>
+    {
+        static_assert(_detail::error<Args...>, "AST callbacks require a lexy::ast_builder");
+        return {};
+    }
+
+    template <typename State, typename Ast = _detect_ast_builder<State>>
+    constexpr auto operator[](const State& state) const
+    {
+        return _ast_node_cb<Ast, Kind>{&state.ast()};
+    }
+};
+
+template <typename Ast, auto Kind>
+struct _ast_children_cb
+{
+    Ast* _ast;
+
+    using return_type = ast_node_id;
+
+    // The node created by the sink.
+    constexpr ast_node_id operator()(ast_node_id node) const
+    {
+        return node;
+    }
+    // There were no items, e.g. for `dsl::opt(dsl::list(...))`.
+    ast_node_id operator()(nullopt&&) const
+    {
+        return _ast->create_node(Kind);
+    }
+};
+
+template <auto Kind>
+struct _ast_children
+{
+    using return_type = ast_node_id;
+
+    constexpr ast_node_id operator()(ast_node_id node) const
+    {
+        return node;
+    }
+    // Only provided so the callback is detected; the parse state is required.
+    template <typename Nullopt, typename = std::enable_if_t<std::is_same_v<Nullopt, nullopt>>>
+    ast_node_id operator()(Nullopt&&) const
+    {
+        static_assert(_detail::error<Nullopt>, "AST callbacks require a lexy::ast_builder");
+        return {};
+    }
+
+    template <typename State, typename Ast = _detect_ast_builder<State>>
+    constexpr auto operator[](const State& state) const
+    {
+        return _ast_children_cb<Ast, Kind>{&state.ast()};
+    }
+
+    template <typename State, typename Ast = _detect_ast_builder<State>>
+    constexpr auto sink(const State& state) const
+    {
+        return _ast_children_sink<Ast, Kind>(&state.ast());
+    }
+};
+
+/// A callback that creates a node of the given kind in the AST of the `lexy::ast_builder`.
+/// A lexeme becomes the text of the node, node ids its children.
+template <auto Kind>
+constexpr auto ast_node = _ast_node<Kind>{};
+
+/// A sink that creates a node of the given kind whose children are the items.
+template <auto Kind>
+constexpr auto ast_children = _ast_children<Kind>{};
+} // namespace lexy
+
+#endif // LEXY_AST_HPP_INCLUDED
+
@@ -28,6 +28,14 @@ template <typename T, typename State>
 constexpr bool is_callback_state
     = _detail::is_detected<_detect_callback_state, T, std::decay_t<State>>;
 
+template <typename T, typename State, typename... Args>
+using _detect_callback_state_for
+    = decltype(LEXY_DECLVAL(const T)[LEXY_DECLVAL(const State&)](LEXY_DECLVAL(Args)...));
+// Whether the callback with the parse state can be invoked with the arguments.
+template <typename T, typename State, typename... Args>
+constexpr bool _is_callback_state_for
+    = _detail::is_detected<_detect_callback_state_for, T, std::decay_t<State>, Args...>;
+
 /// Returns the type of the `.sink()` function.
 template <typename Sink, typename... Args>
 using sink_callback = decltype(LEXY_DECLVAL(Sink).sink(LEXY_DECLVAL(Args)...));
@@ -36,6 +44,38 @@ template <typename T, typename... Args>
 using _detect_sink = decltype(LEXY_DECLVAL(const T).sink(LEXY_DECLVAL(Args)...).finish());
 template <typename T, typename... Args>
 constexpr bool is_sink = _detail::is_detected<_detect_sink, T, Args...>;
+
+template <typename SinkCallback>
+using _detect_sink_reserve = decltype(LEXY_DECLVAL(SinkCallback&).reserve(std::size_t(0)));
+// Whether the sink callback accepts a hint about the number of items it is going to receive.
+template <typename SinkCallback>
+constexpr bool _has_sink_reserve = _detail::is_detected<_detect_sink_reserve, SinkCallback>;
+} // namespace lexy
+
+namespace lexy
+{
+// The memory resource of a parse state, e.g. from `lexy::with_arena()`.
+template <typename State>
+using _detect_memory_resource = decltype(LEXY_DECLVAL(const State&).memory_resource());
+
+template <typename Allocator, typename State>
+using _detect_state_allocator = decltype(Allocator(LEXY_DECLVAL(_detect_memory_resource<State>)));
+// Whether the parse state has a memory resource that can be used to create the allocator.
+template <typename Allocator, typename State>
+constexpr bool _is_state_allocator
+    = _detail::is_detected<_detect_state_allocator, Allocator, State>;
+
+template <typename Allocator>
+struct _state_allocator_fn
+{
+    template <typename State>
+    constexpr Allocator operator()(const State& state) const
+    {
+        return Allocator(state.memory_resource());
+    }
+};
+template <typename Allocator>
+constexpr auto _state_allocator = _state_allocator_fn<Allocator>{};
 } // namespace lexy
 
 #endif // LEXY_CALLBACK_BASE_HPP_INCLUDED
@@ -6,6 +6,7 @@
 #define LEXY_CALLBACK_CONTAINER_HPP_INCLUDED
 
 #include <lexy/callback/base.hpp>
+#include <lexy/small_vector.hpp>
 
 namespace lexy
 {
@@ -35,6 +36,13 @@ struct _list_sink
         return _result.emplace_back(LEXY_FWD(args)...);
     }
 
+    /// Size hint that the sink receives `size` more items.
+    template <typename C = Container>
+    auto reserve(std::size_t size) -> decltype(LEXY_DECLVAL(C&).reserve(size))
+    {
+        return _result.reserve(_result.size() + size);
+    }
+
     Container&& finish() &&
     {
         return LEXY_MOV(_result);
@@ -135,6 +143,22 @@ struct _list
         return _list_sink<Container>{Container(allocator)};
     }
 
+    template <typename State, typename C = Container,
+              typename = std::enable_if_t<_is_state_allocator<typename C::allocator_type, State>>>
+    constexpr auto operator[](const State& state) const
+    {
+        using alloc_fn = _state_allocator_fn<typename C::allocator_type>;
+        return typename _list_alloc<Container, alloc_fn>::template _with_state<State>{
+            state, _state_allocator<typename C::allocator_type>};
+    }
+    template <typename State, typename C = Container,
+              typename = std::enable_if_t<_is_state_allocator<typename C::allocator_type, State>>>
+    constexpr auto sink(const State& state) const
+    {
+        return _list_sink<Container>{
+            Container(_state_allocator<typename C::allocator_type>(state))};
+    }
+
     template <typename AllocFn>
     constexpr auto allocator(AllocFn alloc_fn) const
     {
@@ -148,8 +172,14 @@ struct _list
 
 /// A callback with sink that creates a list of things (e.g. a `std::vector`, `std::list`, etc.).
 /// It repeatedly calls `push_back()` and `emplace_back()`.
+/// If the parse state has a memory resource the allocator can be created from, it is used.
 template <typename Container>
 constexpr auto as_list = _list<Container>{};
+
+/// Same as `as_list`, but creates a `lexy::small_vector`,
+/// which does not allocate memory for up to `N` items.
+template <typename T, std::size_t N>
+constexpr auto as_small_list = _list<small_vector<T, N>>{};
 } // namespace lexy
 
 namespace lexy
@@ -274,6 +304,22 @@ struct _collection
         return _collection_sink<Container>{Container(allocator)};
     }
 
+    template <typename State, typename C = Container,
+              typename = std::enable_if_t<_is_state_allocator<typename C::allocator_type, State>>>
+    constexpr auto operator[](const State& state) const
+    {
+        using alloc_fn = _state_allocator_fn<typename C::allocator_type>;
+        return typename _collection_alloc<Container, alloc_fn>::template _with_state<State>{
+            state, _state_allocator<typename C::allocator_type>};
+    }
+    template <typename State, typename C = Container,
+              typename = std::enable_if_t<_is_state_allocator<typename C::allocator_type, State>>>
+    constexpr auto sink(const State& state) const
+    {
+        return _collection_sink<Container>{
+            Container(_state_allocator<typename C::allocator_type>(state))};
+    }
+
     template <typename AllocFn>
     constexpr auto allocator(AllocFn alloc_fn) const
     {
@@ -287,6 +333,7 @@ struct _collection
 
 /// A callback with sink that creates an unordered collection of things (e.g. a `std::set`,
 /// `std::unordered_map`, etc.). It repeatedly calls `insert()` and `emplace()`.
+/// If the parse state has a memory resource the allocator can be created from, it is used.
 template <typename T>
 constexpr auto as_collection = _collection<T>{};
 } // namespace lexy
@@ -6,6 +6,7 @@
 #define LEXY_CALLBACK_OBJECT_HPP_INCLUDED
 
 #include <lexy/callback/base.hpp>
+#include <new>
 
 namespace lexy::_detail
 {
@@ -57,6 +58,25 @@ struct _construct<void>
 template <typename T>
 constexpr auto construct = _construct<T>{};
 
+template <typename T, typename MemoryResource>
+struct _new_resource
+{
+    MemoryResource* _resource;
+
+    using return_type = T*;
+
+    template <typename... Args>
+    constexpr auto operator()(Args&&... args) const
+        -> std::enable_if_t<_detail::is_constructible<T, Args&&...>, T*>
+    {
+        auto memory = _resource->allocate(sizeof(T), alignof(T));
+        if constexpr (std::is_constructible_v<T, Args&&...>)
+            return ::new (memory) T(LEXY_FWD(args)...);
+        else
+            return ::new (memory) T{LEXY_FWD(args)...};
+    }
+};
+
 template <typename T, typename PtrT>
 struct _new
 {
@@ -93,6 +113,26 @@ struct _new
 /// A callback that constructs an object of type T on the heap by forwarding the arguments.
 template <typename T, typename PtrT = T*>
 constexpr auto new_ = _new<T, PtrT>{};
+
+template <typename T>
+struct _arena_new
+{
+    using return_type = T*;
+
+    template <typename State,
+              typename = std::enable_if_t<_detail::is_detected<_detect_memory_resource, State>>>
+    constexpr auto operator[](const State& state) const
+    {
+        using resource = std::remove_pointer_t<_detect_memory_resource<State>>;
+        return _new_resource<T, resource>{state.memory_resource()};
+    }
+};
+
+/// A callback that constructs an object of type T in the memory resource of the parse state,
+/// e.g. from `lexy::with_arena()`, by forwarding the arguments.
+/// The object is never destroyed.
+template <typename T>
+constexpr auto arena_new = _arena_new<T>{};
 } // namespace lexy
 
 #endif // LEXY_CALLBACK_OBJECT_HPP_INCLUDED
@@ -5,10 +5,12 @@
 #ifndef LEXY_CALLBACK_STRING_HPP_INCLUDED
 #define LEXY_CALLBACK_STRING_HPP_INCLUDED
 
+#include <cstring>
 #include <lexy/_detail/code_point.hpp>
 #include <lexy/callback/base.hpp>
 #include <lexy/encoding.hpp>
 #include <lexy/lexeme.hpp>
+#include <new>
 
 namespace lexy
 {
@@ -74,20 +76,58 @@ struct _as_string
         return String(buffer, buffer + size, allocator);
     }
 
+    template <typename State>
+    struct _with_state
+    {
+        const State& _state;
+
+        constexpr String operator()(nullopt&&) const
+        {
+            return String(_state_allocator<typename String::allocator_type>(_state));
+        }
+        constexpr String operator()(String&& str) const
+        {
+            return LEXY_MOV(str);
+        }
+
+        template <typename Arg>
+        constexpr auto operator()(Arg&& arg) const
+            -> decltype(_as_string{}(LEXY_DECLVAL(const typename String::allocator_type&),
+                                     LEXY_FWD(arg)))
+        {
+            return _as_string{}(_state_allocator<typename String::allocator_type>(_state),
+                                LEXY_FWD(arg));
+        }
+    };
+
+    template <typename State, typename S = String,
+              typename = std::enable_if_t<_is_state_allocator<typename S::allocator_type, State>>>
+    constexpr auto operator[](const State& state) const
+    {
+        return _with_state<State>{state};
+    }
+
     struct _sink
     {
         String _result;
+        // Code points are encoded into a buffer first, which is appended all at once.
+        typename Encoding::char_type _cp_buffer[32];
+        std::size_t                  _cp_size;
 
         using return_type = String;
 
+        explicit _sink(String&& result) : _result(LEXY_MOV(result)), _cp_size(0) {}
+
         template <typename CharT, typename = decltype(LEXY_DECLVAL(String).push_back(CharT()))>
         void operator()(CharT c)
         {
+            _flush();
             _result.push_back(c);
         }
 
         void operator()(String&& str)
         {
+            _flush();
             _result.append(LEXY_MOV(str));
         }
 
@@ -96,20 +136,31 @@ struct _as_string
         {
             static_assert(lexy::char_type_compatible_with_reader<Reader, _char_type>,
                           "cannot convert lexeme to this string type");
+            _flush();
             _result.append(lex.begin(), lex.end());
         }
 
         void operator()(code_point cp)
         {
-            typename Encoding::char_type buffer[4] = {};
-            auto                         size = _detail::encode_code_point<Encoding>(cp, buffer, 4);
-            _result.append(buffer, buffer + size);
+            if (_cp_size + 4 > sizeof(_cp_buffer) / sizeof(_cp_buffer[0]))
+                _flush();
+            _cp_size += _detail::encode_code_point<Encoding>(cp, _cp_buffer + _cp_size, 4);
         }
 
         String&& finish() &&
         {
+            _flush();
             return LEXY_MOV(_result);
         }
+
+        void _flush()
+        {
+            if (_cp_size > 0)
+            {
+                _result.append(_cp_buffer, _cp_buffer + _cp_size);
+                _cp_size = 0;
+            }
+        }
     };
 
     constexpr auto sink() const
@@ -121,15 +172,197 @@ struct _as_string
     {
         return _sink{String(allocator)};
     }
+    template <typename State, typename S = String,
+              typename = std::enable_if_t<_is_state_allocator<typename S::allocator_type, State>>>
+    constexpr auto sink(const State& state) const
+    {
+        return _sink{String(_state_allocator<typename S::allocator_type>(state))};
+    }
 };
 
 /// A callback with sink that creates a string (e.g. `std::string`).
 /// As a callback, it converts a lexeme into the string.
 /// As a sink, it repeatedly calls `.push_back()` for individual characters,
 /// or `.append()` for lexemes or other strings.
+/// If the parse state has a memory resource the allocator can be created from, it is used.
 template <typename String, typename Encoding = deduce_encoding<_string_char_type<String>>>
 constexpr auto as_string = _as_string<String, Encoding>{};
 } // namespace lexy
 
+namespace lexy
+{
+template <typename StringView, typename Encoding>
+struct _as_string_view
+{
+    using return_type = StringView;
+    using _char_type  = _string_char_type<StringView>;
+    static_assert(lexy::_detail::is_compatible_char_type<Encoding, _char_type>,
+                  "invalid character type/encoding combination");
+
+    constexpr StringView operator()(nullopt&&) const
+    {
+        return StringView();
+    }
+    constexpr StringView operator()(StringView&& str) const
+    {
+        return LEXY_MOV(str);
+    }
+
+    template <typename Reader>
+    constexpr StringView operator()(lexeme<Reader> lex) const
+    {
+        static_assert(std::is_convertible_v<typename lexeme<Reader>::iterator, const _char_type*>,
+                      "lexeme must point into contiguous memory of the string view's char type");
+        return StringView(lex.data(), lex.size());
+    }
+
+    template <typename MemoryResource>
+    class _sink
+    {
+    public:
+        using return_type = StringView;
+
+        constexpr explicit _sink(MemoryResource* resource)
+        : _resource(resource), _data(nullptr), _size(0), _buffer(nullptr), _capacity(0),
+          _hint(0)
+        {}
+
+        template <typename CharT,
+                  typename = std::enable_if_t<std::is_convertible_v<CharT, _char_type>>>
+        void operator()(CharT c)
+        {
+            auto ch = _char_type(c);
+            _append(&ch, 1);
+        }
+
+        void operator()(const StringView& str)
+        {
+            _append(str.data(), str.size());
+        }
+
+        template <typename Reader>
+        void operator()(lexeme<Reader> lex)
+        {
+            static_assert(lexy::char_type_compatible_with_reader<Reader, _char_type>,
+                          "cannot convert lexeme to this string type");
+
+            using iterator = typename lexeme<Reader>::iterator;
+            if constexpr (std::is_convertible_v<iterator, const _char_type*>)
+            {
+                if (_size == 0 && _buffer == nullptr)
+                {
+                    // The first run of characters, so we can refer to the input directly.
+                    _data = lex.data();
+                    _size = lex.size();
+                }
+                else
+                {
+                    _append(lex.data(), lex.size());
+                }
+            }
+            else
+            {
+                for (auto c : lex)
+                    (*this)(c);
+            }
+        }
+
+        void operator()(code_point cp)
+        {
+            if constexpr (std::is_same_v<typename Encoding::char_type, _char_type>)
+            {
+                // Encode it directly into the buffer.
+                _grow(4);
+                _size += _detail::encode_code_point<Encoding>(cp, _buffer + _size, 4);
+            }
+            else
+            {
+                typename Encoding::char_type buffer[4] = {};
+                auto size = _detail::encode_code_point<Encoding>(cp, buffer, 4);
+                for (auto i = std::size_t(0); i != size; ++i)
+                    (*this)(buffer[i]);
+            }
+        }
+
+        /// Size hint that the sink receives (approximately) `size` more characters.
+        /// It is only used up to a limit, as it might come from the input.
+        void reserve(std::size_t size)
+        {
+            constexpr auto max_hint = std::size_t(4 * 1024);
+            if (size > max_hint)
+                size = max_hint;
+
+            if (_hint < _size + size)
+                _hint = _size + size;
+        }
+
+        StringView finish() &&
+        {
+            return StringView(_data, _size);
+        }
+
+    private:
+        void _grow(std::size_t size)
+        {
+            // If we do not have a buffer yet, `_data` might still refer to the input.
+            if (_buffer == nullptr || _capacity - _size < size)
+            {
+                constexpr auto max_capacity = std::size_t(-1) / sizeof(_char_type);
+                if (size > max_capacity - _size)
+                    throw std::bad_array_new_length();
+
+                // We need to copy the characters into a (bigger) buffer owned by the resource.
+                auto new_capacity = _hint;
+                if (_buffer != nullptr)
+                    new_capacity = _capacity <= max_capacity / 2 ? 2 * _capacity : max_capacity;
+                if (new_capacity < _size + size)
+                    new_capacity = _size + size;
+
+                auto new_buffer = static_cast<_char_type*>(
+                    _resource->allocate(new_capacity * sizeof(_char_type), alignof(_char_type)));
+                if (_size > 0)
+                    std::memcpy(new_buffer, _data, _size * sizeof(_char_type));
+                if (_buffer != nullptr)
+                    _resource->deallocate(_buffer, _capacity * sizeof(_char_type),
+                                          alignof(_char_type));
+
+                _buffer   = new_buffer;
+                _capacity = new_capacity;
+                _data     = _buffer;
+            }
+        }
+
+        void _append(const _char_type* str, std::size_t size)
+        {
+            _grow(size);
+            std::memcpy(_buffer + _size, str, size * sizeof(_char_type));
+            _size += size;
+        }
+
+        MemoryResource*   _resource;
+        const _char_type* _data;
+        std::size_t       _size;
+        _char_type*       _buffer;
+        std::size_t       _capacity;
+        std::size_t       _hint;
+    };
+
+    template <typename State, typename = _detect_memory_resource<State>>
+    constexpr auto sink(const State& state) const
+    {
+        using resource = std::remove_pointer_t<_detect_memory_resource<State>>;
+        return _sink<resource>(state.memory_resource());
+    }
+};
+
+/// A callback with sink that creates a string view (e.g. `std::string_view`).
+/// As a callback, it refers to the characters of a lexeme.
+/// As a sink, it refers to the input if it only receives one lexeme, e.g. in `dsl::delimited`
+/// without escape sequences. Otherwise, the characters are copied into memory allocated from the
+/// memory resource of the parse state, e.g. from `lexy::with_arena()`, which must outlive it.
+template <typename StringView, typename Encoding = deduce_encoding<_string_char_type<StringView>>>
+constexpr auto as_string_view = _as_string_view<StringView, Encoding>{};
+} // namespace lexy
+
 #endif // LEXY_CALLBACK_STRING_HPP_INCLUDED
 
@@ -8,9 +8,88 @@
 #include <lexy/dsl/base.hpp>
 #include <lexy/dsl/literal.hpp>
 #include <lexy/dsl/terminator.hpp>
+#include <lexy/dsl/token.hpp>
 
 namespace lexyd
 {
+template <typename Open, typename Close, typename... Atoms>
+struct _brackets_skip : token_base<_brackets_skip<Open, Close, Atoms...>>
+{
+    template <typename Reader>
+    struct tp
+    {
+        typename Reader::iterator end;
+
+        constexpr explicit tp(const Reader& reader) : end(reader.position()) {}
+
+        constexpr bool try_parse(Reader reader)
+        {
+            if (!lexy::try_match_token(Open{}, reader))
+            {
+                // We don't have an opening bracket, so we don't consume anything.
+                end = reader.position();
+                return false;
+            }
+
+            auto depth = 1u;
+            while (true)
+            {
+                // Skip over atoms first, as they might contain brackets that need to be ignored.
+                if ((lexy::try_match_token(Atoms{}, reader) || ...))
+                    continue;
+
+                if (lexy::try_match_token(Close{}, reader))
+                {
+                    if (--depth == 0)
+                        break;
+                }
+                else if (lexy::try_match_token(Open{}, reader))
+                {
+                    ++depth;
+                }
+                else if (reader.peek() == Reader::encoding::eof())
+                {
+                    // The brackets are unbalanced.
+                    end = reader.position();
+                    return false;
+                }
+                else
+                {
+                    reader.bump();
+                }
+            }
+
+            end = reader.position();
+            return true;
+        }
+
+        template <typename Context>
+        constexpr void report_error(Context& context, Reader reader)
+        {
+            if (reader.position() == end)
+            {
+                // We've failed to match the opening bracket, report its error.
+                lexy::token_parser_for<Open, Reader> parser(reader);
+                auto                                 result = parser.try_parse(reader);
+                LEXY_ASSERT(!result, "open bracket shouldn't have matched?!");
+                parser.report_error(context, reader);
+            }
+            else
+            {
+                // We've reached EOF before the final closing bracket, report its error there.
+                reader.set_position(end);
+                LEXY_ASSERT(reader.peek() == Reader::encoding::eof(),
+                            "forgot to set end in try_parse()");
+
+                lexy::token_parser_for<Close, Reader> parser(reader);
+                auto                                  result = parser.try_parse(reader);
+                LEXY_ASSERT(!result, "close bracket shouldn't have matched?!");
+                parser.report_error(context, reader);
+            }
+        }
+    };
+};
+
 template <typename Open, typename Close, typename... RecoveryLimit>
 struct _brackets
 {
@@ -72,6 +151,18 @@ struct _brackets
         return open() >> as_terminator().opt_list(r, sep);
     }
 
+    /// Matches everything from the open bracket to the matching close bracket as a single token,
+    /// without parsing anything in between.
+    /// Brackets inside one of the atoms, e.g. a string literal, are not counted.
+    template <typename... Atoms>
+    constexpr auto skip(Atoms...) const
+    {
+        static_assert(lexy::is_token_rule<Open> && lexy::is_token_rule<Close>,
+                      "skip() requires token brackets");
+        static_assert((lexy::is_token_rule<Atoms> && ...));
+        return _brackets_skip<Open, Close, Atoms...>{};
+    }
+
     //=== access ===//
     /// Matches the open bracket.
     constexpr auto open() const
@@ -5,6 +5,7 @@
 #ifndef LEXY_DSL_PRODUCTION_HPP_INCLUDED
 #define LEXY_DSL_PRODUCTION_HPP_INCLUDED
 
+#include <lexy/_detail/detect.hpp>
 #include <lexy/action/base.hpp>
 #include <lexy/dsl/base.hpp>
 #include <lexy/dsl/branch.hpp>
@@ -19,17 +20,53 @@ constexpr auto inline_ = lexy::production_rule<Production>{};
 
 namespace lexyd
 {
+template <typename Handler, typename Production>
+using _detect_defer_production = decltype(Handler::template defer_production<Production>);
+
+// Whether the parse handler wants to skip over the production instead of parsing its rule.
+template <typename Context, typename Production>
+constexpr bool _is_deferred_production = [] {
+    using handler = LEXY_DECAY_DECLTYPE(LEXY_DECLVAL(Context).control_block->parse_handler);
+    if constexpr (lexy::_detail::is_detected<_detect_defer_production, handler, Production>)
+        return handler::template defer_production<Production>;
+    else
+        return false;
+}();
+
 template <typename Production, typename Context, typename Reader>
 /* not force inline */ constexpr bool _parse_production(Context& context, Reader& reader)
 {
-    using parser = lexy::parser_for<lexy::production_rule<Production>, lexy::_detail::final_parser>;
-    return parser::parse(context, reader);
+    if constexpr (_is_deferred_production<Context, Production>)
+    {
+        static_assert(std::is_void_v<typename Context::value_type>,
+                      "only productions without a value can be deferred");
+
+        // Match the extent of the production as a single token instead.
+        using deferred = LEXY_DECAY_DECLTYPE(Production::deferred);
+        using parser   = lexy::parser_for<deferred, lexy::_detail::final_parser>;
+        return parser::parse(context, reader);
+    }
+    else
+    {
+        using parser
+            = lexy::parser_for<lexy::production_rule<Production>, lexy::_detail::final_parser>;
+        return parser::parse(context, reader);
+    }
 }
-template <typename ProductionParser, typename Context, typename Reader>
+template <typename Production, typename ProductionParser, typename Context, typename Reader>
 /* not force inline */ constexpr bool _finish_production(ProductionParser& parser, Context& context,
                                                          Reader& reader)
 {
-    return parser.template finish<lexy::_detail::final_parser>(context, reader);
+    if constexpr (_is_deferred_production<Context, Production>)
+    {
+        // We only needed the branch condition, the extent is matched from the beginning again.
+        parser.cancel(context);
+        return _parse_production<Production>(context, reader);
+    }
+    else
+    {
+        return parser.template finish<lexy::_detail::final_parser>(context, reader);
+    }
 }
 
 template <typename Production>
@@ -92,7 +129,7 @@ struct _prd : _copy_base<lexy::production_rule<Production>>
             // Finish the production in a new context.
             auto sub_context = context.sub_context(Production{});
             sub_context.on(_ev::production_start{}, begin);
-            if (_finish_production(parser, sub_context, reader))
+            if (_finish_production<Production>(parser, sub_context, reader))
             {
                 sub_context.on(_ev::production_finish{}, reader.position());
 
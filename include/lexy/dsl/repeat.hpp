@@ -99,6 +99,14 @@ struct _repl : rule_base // repeat, list
                                            Args&&... args)
         {
             auto sink = context.value_callback().sink();
+            if constexpr (lexy::_has_sink_reserve<decltype(sink)>)
+            {
+                // We know the number of items upfront, but it comes from the input:
+                // only trust it up to a limit, so a bogus count doesn't allocate a huge amount of
+                // memory before the missing items are reported.
+                constexpr auto max_reserve = std::size_t(1024);
+                sink.reserve(count < max_reserve ? count : max_reserve);
+            }
             if (!_rep_impl<Item, Sep>::loop(context, reader, count, sink))
                 return false;
 
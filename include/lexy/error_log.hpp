@@ -0,0 +1,248 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef LEXY_ERROR_LOG_HPP_INCLUDED
+#define LEXY_ERROR_LOG_HPP_INCLUDED
+
+#include <cstdint>
+#include <lexy/_detail/assert.hpp>
+#include <lexy/_detail/config.hpp>
+#include <lexy/error.hpp>
+#include <lexy/memory_resource.hpp>
+#include <vector>
+
+namespace lexy
+{
+/// The kind of an error, i.e. which specialization of `lexy::error` it was.
+enum class error_kind : std::uint8_t
+{
+    generic,
+    expected_literal,
+    expected_keyword,
+    expected_char_class,
+};
+
+/// A compact record of an error, which does not own any memory.
+///
+/// It stores the information of the `lexy::error` and its `lexy::error_context`;
+/// everything else, like the location or a formatted message, can be computed from it as needed.
+template <typename Input>
+class error_record
+{
+public:
+    using iterator  = typename input_reader<Input>::iterator;
+    using char_type = typename input_reader<Input>::encoding::char_type;
+
+    template <typename Production, typename Tag>
+    constexpr explicit error_record(const error_context<Production, Input>&,
+                                    const error_for<Input, Tag>& error) noexcept
+    : _kind(error_kind::generic), _index(0), _production(production_name<Production>()), _str(),
+      _begin(error.position()), _end(error.position())
+    {
+        if constexpr (std::is_same_v<Tag, expected_literal>)
+        {
+            LEXY_PRECONDITION(error.index() <= UINT32_MAX);
+            _kind       = error_kind::expected_literal;
+            _index      = std::uint32_t(error.index());
+            _str.string = error.string();
+        }
+        else if constexpr (std::is_same_v<Tag, expected_keyword>)
+        {
+            _kind       = error_kind::expected_keyword;
+            _str.string = error.string();
+            _end        = error.end();
+        }
+        else if constexpr (std::is_same_v<Tag, expected_char_class>)
+        {
+            _kind     = error_kind::expected_char_class;
+            _str.name = error.character_class();
+        }
+        else
+        {
+            _str.name = error.message();
+            _end      = error.end();
+        }
+    }
+
+    constexpr error_kind kind() const noexcept
+    {
+        return _kind;
+    }
+
+    /// The name of the production where the error occurred.
+    constexpr const char* production() const noexcept
+    {
+        return _production;
+    }
+
+    constexpr iterator position() const noexcept
+    {
+        return _begin;
+    }
+    constexpr iterator begin() const noexcept
+    {
+        return _begin;
+    }
+    constexpr iterator end() const noexcept
+    {
+        return _end;
+    }
+
+    /// The message of a generic error.
+    constexpr const char* message() const noexcept
+    {
+        LEXY_PRECONDITION(_kind == error_kind::generic);
+        return _str.name;
+    }
+
+    /// The name of the character class of an `expected_char_class` error.
+    constexpr const char* character_class() const noexcept
+    {
+        LEXY_PRECONDITION(_kind == error_kind::expected_char_class);
+        return _str.name;
+    }
+
+    /// The string of an `expected_literal` or `expected_keyword` error.
+    constexpr const char_type* string() const noexcept
+    {
+        LEXY_PRECONDITION(_kind == error_kind::expected_literal
+                          || _kind == error_kind::expected_keyword);
+        return _str.string;
+    }
+
+    /// The index of the character of an `expected_literal` error.
+    constexpr std::size_t index() const noexcept
+    {
+        LEXY_PRECONDITION(_kind == error_kind::expected_literal);
+        return _index;
+    }
+
+private:
+    error_kind    _kind;
+    std::uint32_t _index;
+    const char*   _production;
+    union
+    {
+        const char*      name;
+        const char_type* string;
+    } _str;
+    iterator _begin, _end;
+};
+
+/// Stores the errors of one or more parses as `lexy::error_record`s.
+///
+/// It can be cleared and reused, which keeps the memory,
+/// so that parsing input with many errors does not allocate for each one.
+template <typename Input, typename MemoryResource = void>
+class error_log
+{
+    using _vector = std::vector<error_record<Input>,
+                                resource_allocator<error_record<Input>, MemoryResource>>;
+
+public:
+    using input_type     = Input;
+    using record_type    = error_record<Input>;
+    using const_iterator = typename _vector::const_iterator;
+
+    explicit error_log(MemoryResource* resource = _detail::get_memory_resource<MemoryResource>())
+    : _records(resource)
+    {}
+
+    //=== access ===//
+    bool empty() const noexcept
+    {
+        return _records.empty();
+    }
+    std::size_t size() const noexcept
+    {
+        return _records.size();
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return _records.begin();
+    }
+    const_iterator end() const noexcept
+    {
+        return _records.end();
+    }
+
+    const record_type& operator[](std::size_t idx) const noexcept
+    {
+        LEXY_PRECONDITION(idx < size());
+        return _records[idx];
+    }
+
+    //=== modifiers ===//
+    void reserve(std::size_t capacity)
+    {
+        _records.reserve(capacity);
+    }
+
+    /// Removes all records, but keeps the memory.
+    void clear() noexcept
+    {
+        _records.clear();
+    }
+
+    template <typename Production, typename Tag>
+    void record(const error_context<Production, Input>& context,
+                const error_for<Input, Tag>&            error)
+    {
+        _records.emplace_back(context, error);
+    }
+
+private:
+    _vector _records;
+};
+} // namespace lexy
+
+namespace lexy
+{
+template <typename Log>
+class _log_errors_sink
+{
+public:
+    using return_type = std::size_t;
+
+    constexpr explicit _log_errors_sink(Log& log) noexcept : _log(&log), _count(0) {}
+
+    template <typename Production, typename Tag>
+    void operator()(const error_context<Production, typename Log::input_type>& context,
+                    const error_for<typename Log::input_type, Tag>&            error)
+    {
+        _log->record(context, error);
+        ++_count;
+    }
+
+    constexpr std::size_t finish() && noexcept
+    {
+        return _count;
+    }
+
+private:
+    Log*        _log;
+    std::size_t _count;
+};
+
+template <typename Log>
+struct _log_errors
+{
+    Log* _log;
+
+    constexpr auto sink() const
+    {
+        return _log_errors_sink<Log>(*_log);
+    }
+};
+
+/// An error callback that appends all errors to the log and returns their number.
+template <typename Input, typename MemoryResource>
+constexpr auto log_errors(error_log<Input, MemoryResource>& log)
+{
+    return _log_errors<error_log<Input, MemoryResource>>{&log};
+}
+} // namespace lexy
+
+#endif // LEXY_ERROR_LOG_HPP_INCLUDED
@@ -240,12 +240,13 @@ public:
     template <typename... Args>
     constexpr return_type operator()(Args&&... args)
     {
-        if constexpr (lexy::is_callback_for<_type, Args&&...>)
+        if constexpr (lexy::_is_callback_state_for<_type, ParseState, Args&&...>)
         {
-            if constexpr (lexy::is_callback_state<_type, ParseState>)
-                return Production::value[*_state](LEXY_FWD(args)...);
-            else
-                return Production::value(LEXY_FWD(args)...);
+            return Production::value[*_state](LEXY_FWD(args)...);
+        }
+        else if constexpr (lexy::is_callback_for<_type, Args&&...>)
+        {
+            return Production::value(LEXY_FWD(args)...);
         }
         else if constexpr (lexy::is_sink<_type> || lexy::is_sink<_type, ParseState>)
         {
@@ -5,7 +5,9 @@
 #ifndef LEXY_INPUT_BUFFER_HPP_INCLUDED
 #define LEXY_INPUT_BUFFER_HPP_INCLUDED
 
+#include <cstdint>
 #include <cstring>
+#include <lexy/_detail/code_point.hpp>
 #include <lexy/_detail/memory_resource.hpp>
 #include <lexy/error.hpp>
 #include <lexy/input/base.hpp>
@@ -156,6 +158,30 @@ public:
     : buffer(view.data(), view.size(), resource)
     {}
 
+    /// The number of bytes that have to be allocated for a buffer of the given size.
+    static constexpr std::size_t allocation_size(std::size_t size) noexcept
+    {
+        if constexpr (_has_sentinel)
+            return (size + 1) * sizeof(char_type);
+        else
+            return size * sizeof(char_type);
+    }
+
+    /// Takes ownership of `allocation_size(size)` bytes of memory allocated from the resource,
+    /// whose first `size` characters have been initialized.
+    static buffer adopt(char_type* data, std::size_t size,
+                        MemoryResource* resource
+                        = _detail::get_memory_resource<MemoryResource>()) noexcept
+    {
+        if constexpr (_has_sentinel)
+            data[size] = encoding::eof();
+
+        buffer result(resource);
+        result._data = data;
+        result._size = size;
+        return result;
+    }
+
     buffer(const buffer& other) : buffer(other.data(), other.size(), other._resource.get()) {}
     buffer(const buffer& other, MemoryResource* resource)
     : buffer(other.data(), other.size(), resource)
@@ -266,6 +292,53 @@ buffer(const View&, MemoryResource*)
     -> buffer<deduce_encoding<LEXY_DECAY_DECLTYPE(*LEXY_DECLVAL(View).data())>, MemoryResource>;
 
 //=== make_buffer ===//
+// Swaps the bytes of each code unit of size N stored in the word.
+template <std::size_t N>
+LEXY_FORCE_INLINE constexpr std::uint64_t _byte_swap_word(std::uint64_t word) noexcept
+{
+    static_assert(N == 2 || N == 4);
+#if defined(__GNUC__) || defined(__clang__)
+    if constexpr (N == 4)
+    {
+        // Reverse all bytes, then swap the two lanes back into place.
+        word = __builtin_bswap64(word);
+        return (word << 32) | (word >> 32);
+    }
+#endif
+
+    // Swap the bytes of each 16 bit lane.
+    word = ((word & 0x00FF'00FF'00FF'00FF) << 8) | ((word >> 8) & 0x00FF'00FF'00FF'00FF);
+    if constexpr (N == 4)
+        // Swap the 16 bit lanes of each 32 bit lane.
+        word = ((word & 0x0000'FFFF'0000'FFFF) << 16) | ((word >> 16) & 0x0000'FFFF'0000'FFFF);
+    return word;
+}
+
+// Copies `size` code units from `src`, swapping the bytes of each one.
+template <typename CharT>
+void _byte_swap_copy(CharT* dest, const unsigned char* src, std::size_t size) noexcept
+{
+    // We swap eight bytes at a time using bit operations on a 64 bit word (SWAR).
+    constexpr auto units_per_word = sizeof(std::uint64_t) / sizeof(CharT);
+
+    auto idx = std::size_t(0);
+    for (; size - idx >= units_per_word; idx += units_per_word)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, src + idx * sizeof(CharT), sizeof(word));
+        word = _byte_swap_word<sizeof(CharT)>(word);
+        std::memcpy(dest + idx, &word, sizeof(word));
+    }
+
+    for (; idx != size; ++idx)
+    {
+        std::uint64_t word = 0;
+        std::memcpy(&word, src + idx * sizeof(CharT), sizeof(CharT));
+        word = _byte_swap_word<sizeof(CharT)>(word);
+        std::memcpy(dest + idx, &word, sizeof(CharT));
+    }
+}
+
 template <typename Encoding, encoding_endianness Endian>
 struct _make_buffer
 {
@@ -290,29 +363,11 @@ struct _make_buffer
         }
         else
         {
+            static_assert(Endian != encoding_endianness::bom, "unhandled encoding/endianness");
+
             typename buffer<Encoding, MemoryResource>::builder builder(size / sizeof(char_type),
                                                                        resource);
-
-            const auto end = memory + size;
-            for (auto dest = builder.data(); memory != end; memory += sizeof(char_type))
-            {
-                constexpr auto is_char16 = std::is_same_v<char_type, char16_t>;
-                constexpr auto is_char32 = std::is_same_v<char_type, char32_t>;
-
-                // We convert each group of bytes to the appropriate value.
-                if constexpr (is_char16 && Endian == encoding_endianness::little)
-                    *dest++ = static_cast<char_type>((memory[0] << 0) | (memory[1] << 8));
-                else if constexpr (is_char32 && Endian == encoding_endianness::little)
-                    *dest++ = static_cast<char_type>((memory[0] << 0) | (memory[1] << 8)
-                                                     | (memory[2] << 16) | (memory[3] << 24));
-                else if constexpr (is_char16 && Endian == encoding_endianness::big)
-                    *dest++ = static_cast<char_type>((memory[0] << 8) | (memory[1] << 0));
-                else if constexpr (is_char32 && Endian == encoding_endianness::big)
-                    *dest++ = static_cast<char_type>((memory[0] << 24) | (memory[1] << 16)
-                                                     | (memory[2] << 8) | (memory[3] << 0));
-                else
-                    static_assert(_detail::error<Encoding>, "unhandled encoding/endianness");
-            }
+            _byte_swap_copy(builder.data(), memory, builder.size());
 
             return LEXY_MOV(builder).finish();
         }
@@ -385,6 +440,200 @@ struct _make_buffer<utf32_encoding, encoding_endianness::bom>
 template <typename Encoding, encoding_endianness Endianness>
 constexpr auto make_buffer_from_raw = _make_buffer<Encoding, Endianness>{};
 
+//=== make_buffer_transcoded ===//
+/// The encodings that can be transcoded by `make_buffer_transcoded()`.
+enum class source_encoding
+{
+    /// ISO-8859-1, where every byte is the code point of the same value.
+    latin1,
+    /// UTF-16 in little endian.
+    utf16_little,
+    /// UTF-16 in big endian.
+    utf16_big,
+    /// UTF-16 with an optional BOM, defaulting to big endian if there is none.
+    utf16_bom,
+};
+
+inline std::uint64_t _load_word(const unsigned char* src) noexcept
+{
+    std::uint64_t word;
+    std::memcpy(&word, src, sizeof(word));
+    return word;
+}
+
+// The number of UTF-8 code units required for the Latin-1 input.
+inline std::size_t _latin1_utf8_size(const unsigned char* src, std::size_t size) noexcept
+{
+    // Every byte with the high bit set needs two code units.
+    auto result = size;
+
+    auto idx = std::size_t(0);
+    for (; size - idx >= 8; idx += 8)
+    {
+        // Move the high bits into the lowest bit of each byte, then add all bytes together.
+        auto high_bits = (_load_word(src + idx) >> 7) & 0x0101'0101'0101'0101;
+        result += std::size_t((high_bits * 0x0101'0101'0101'0101) >> 56);
+    }
+    for (; idx != size; ++idx)
+        result += std::size_t(src[idx] >> 7);
+
+    return result;
+}
+
+inline void _latin1_to_utf8(LEXY_CHAR8_T* dest, const unsigned char* src,
+                            std::size_t size) noexcept
+{
+    auto encode = [&](unsigned char c) {
+        if (c < 0x80)
+        {
+            *dest++ = LEXY_CHAR8_T(c);
+        }
+        else
+        {
+            *dest++ = LEXY_CHAR8_T(0xC0 | (c >> 6));
+            *dest++ = LEXY_CHAR8_T(0x80 | (c & 0x3F));
+        }
+    };
+
+    auto idx = std::size_t(0);
+    for (; size - idx >= 8; idx += 8)
+    {
+        if ((_load_word(src + idx) & 0x8080'8080'8080'8080) == 0)
+        {
+            // Eight ASCII characters, which we can copy as-is.
+            std::memcpy(dest, src + idx, 8);
+            dest += 8;
+        }
+        else
+        {
+            for (auto i = 0u; i != 8; ++i)
+                encode(src[idx + i]);
+        }
+    }
+    for (; idx != size; ++idx)
+        encode(src[idx]);
+}
+
+// Transcodes `units` UTF-16 code units into UTF-8 and returns the number of UTF-8 code units.
+// If `Write` is false, it only computes the number without writing anything.
+// Unpaired surrogates are replaced by U+FFFD.
+template <bool BigEndian, bool Write>
+std::size_t _utf16_to_utf8(LEXY_CHAR8_T* dest, const unsigned char* src,
+                           std::size_t units) noexcept
+{
+    constexpr auto high = BigEndian ? 0 : 1;
+    auto           unit = [&](std::size_t idx) {
+        return char32_t(src[2 * idx + high] << 8 | src[2 * idx + 1 - high]);
+    };
+
+    // A code unit is ASCII if its high byte is zero and its low byte doesn't have the high bit set.
+    constexpr unsigned char ascii_mask_bytes[]
+        = {BigEndian ? 0xFF : 0x80, BigEndian ? 0x80 : 0xFF, BigEndian ? 0xFF : 0x80,
+           BigEndian ? 0x80 : 0xFF, BigEndian ? 0xFF : 0x80, BigEndian ? 0x80 : 0xFF,
+           BigEndian ? 0xFF : 0x80, BigEndian ? 0x80 : 0xFF};
+    auto ascii_mask = _load_word(ascii_mask_bytes);
+
+    auto result = std::size_t(0);
+    auto encode = [&](std::size_t& idx) {
+        auto cp = unit(idx++);
+        if (cp >= 0xD800 && cp <= 0xDFFF)
+        {
+            if (cp <= 0xDBFF && idx != units && unit(idx) >= 0xDC00 && unit(idx) <= 0xDFFF)
+            {
+                cp = 0x1'0000 + ((cp - 0xD800) << 10) + (unit(idx) - 0xDC00);
+                ++idx;
+            }
+            else
+            {
+                cp = 0xFFFD;
+            }
+        }
+
+        if constexpr (Write)
+            result += _detail::encode_code_point<utf8_encoding>(code_point(cp), dest + result, 4);
+        else
+            result += cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x1'0000 ? 3 : 4;
+    };
+
+    auto idx = std::size_t(0);
+    while (units - idx >= 4)
+    {
+        if ((_load_word(src + 2 * idx) & ascii_mask) == 0)
+        {
+            // Four ASCII characters, we only need to drop the zero bytes.
+            if constexpr (Write)
+                for (auto i = 0u; i != 4; ++i)
+                    dest[result + i] = LEXY_CHAR8_T(src[2 * (idx + i) + 1 - high]);
+            result += 4;
+            idx += 4;
+        }
+        else
+        {
+            // A surrogate pair might end after the four code units, which is fine.
+            for (auto end = idx + 4; idx < end;)
+                encode(idx);
+        }
+    }
+    while (idx != units)
+        encode(idx);
+
+    return result;
+}
+
+template <bool BigEndian, typename Encoding, typename MemoryResource>
+auto _utf16_transcoded_buffer(const unsigned char* memory, std::size_t units,
+                              MemoryResource* resource)
+{
+    auto size = _utf16_to_utf8<BigEndian, false>(nullptr, memory, units);
+    typename buffer<Encoding, MemoryResource>::builder builder(size, resource);
+    _utf16_to_utf8<BigEndian, true>(builder.data(), memory, units);
+    return LEXY_MOV(builder).finish();
+}
+
+/// Creates a buffer with the specified encoding from raw memory in a different encoding.
+///
+/// The input is transcoded directly into the memory of the buffer: it is traversed once to compute
+/// the size of the result and once more to write it.
+template <typename Encoding, typename MemoryResource = void>
+auto make_buffer_transcoded(const void* _memory, std::size_t size, source_encoding source,
+                            MemoryResource* resource
+                            = _detail::get_memory_resource<MemoryResource>())
+    -> buffer<Encoding, MemoryResource>
+{
+    static_assert(std::is_same_v<Encoding, utf8_encoding>, "can only transcode into UTF-8");
+    auto memory = static_cast<const unsigned char*>(_memory);
+
+    if (source == source_encoding::latin1)
+    {
+        auto utf8_size = _latin1_utf8_size(memory, size);
+        typename buffer<Encoding, MemoryResource>::builder builder(utf8_size, resource);
+        _latin1_to_utf8(builder.data(), memory, size);
+        return LEXY_MOV(builder).finish();
+    }
+
+    LEXY_PRECONDITION(size % 2 == 0);
+    auto big_endian = source != source_encoding::utf16_little;
+    if (source == source_encoding::utf16_bom && size >= 2)
+    {
+        if (memory[0] == 0xFF && memory[1] == 0xFE)
+        {
+            big_endian = false;
+            memory += 2;
+            size -= 2;
+        }
+        else if (memory[0] == 0xFE && memory[1] == 0xFF)
+        {
+            memory += 2;
+            size -= 2;
+        }
+    }
+
+    if (big_endian)
+        return _utf16_transcoded_buffer<true, Encoding>(memory, size / 2, resource);
+    else
+        return _utf16_transcoded_buffer<false, Encoding>(memory, size / 2, resource);
+}
+
 //=== convenience typedefs ===//
 template <typename Encoding = default_encoding, typename MemoryResource = void>
 using buffer_lexeme = lexeme_for<buffer<Encoding, MemoryResource>>;
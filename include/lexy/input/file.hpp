@@ -48,10 +48,51 @@ file_error read_file(const char* path, file_callback cb, void* user_data);
 
 // Same as above, but reads from stdin.
 file_error read_stdin(file_callback cb, void* user_data);
+
+using read_files_callback = void (*)(void* user_data, std::size_t index, file_error ec,
+                                     const char* memory, std::size_t size);
+
+// Allocates memory that is backed by transparent huge pages if it is big enough.
+void* allocate_huge_pages(std::size_t bytes);
+void  deallocate_huge_pages(void* memory, std::size_t bytes) noexcept;
+
+// The size of the anonymous mapping used for an allocation of that many bytes,
+// which is exactly what `deallocate_huge_pages()` unmaps, or zero if it isn't mapped.
+// It depends on how the library was built, so it isn't constexpr.
+std::size_t huge_page_mapping_size(std::size_t bytes) noexcept;
+
+// Reads the entire contents of all specified files into memory.
+// Invokes the callback with the index of each file in the order they have been read,
+// passing either the memory (ec == _success) or the error (memory == nullptr).
+void read_files(const char* const* paths, std::size_t count, read_files_callback cb,
+                void* user_data);
 } // namespace lexy::_detail
 
 namespace lexy
 {
+/// A memory resource for big buffers that asks the OS to back them with huge pages.
+/// This reduces TLB misses when parsing inputs that are several MiB big.
+class huge_page_resource
+{
+public:
+    static void* allocate(std::size_t bytes, std::size_t alignment)
+    {
+        LEXY_PRECONDITION(alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        (void)alignment;
+        return _detail::allocate_huge_pages(bytes);
+    }
+
+    static void deallocate(void* ptr, std::size_t bytes, std::size_t) noexcept
+    {
+        _detail::deallocate_huge_pages(ptr, bytes);
+    }
+
+    friend constexpr bool operator==(huge_page_resource, huge_page_resource) noexcept
+    {
+        return true;
+    }
+};
+
 template <typename Encoding = default_encoding, typename MemoryResource = void>
 class read_file_result
 {
@@ -147,6 +188,59 @@ auto read_file(const char*     path,
     return read_file_result(error, LEXY_MOV(user_data.buffer));
 }
 
+/// Reads the file at the specified path into a buffer, transcoding it from the source encoding.
+///
+/// Big files are mapped into memory, so the file is never copied before it is transcoded.
+template <typename Encoding, typename MemoryResource = void>
+auto read_file_transcoded(const char* path, source_encoding source,
+                          MemoryResource* resource = _detail::get_memory_resource<MemoryResource>())
+    -> read_file_result<Encoding, MemoryResource>
+{
+    struct user_data_t
+    {
+        lexy::buffer<Encoding, MemoryResource> buffer;
+        source_encoding                        source;
+        MemoryResource*                        resource;
+    } user_data{lexy::buffer<Encoding, MemoryResource>(resource), source, resource};
+
+    auto callback = [](void* _user_data, const char* memory, std::size_t size) {
+        auto user_data = static_cast<user_data_t*>(_user_data);
+        user_data->buffer
+            = lexy::make_buffer_transcoded<Encoding>(memory, size, user_data->source,
+                                                     user_data->resource);
+    };
+    auto error = _detail::read_file(path, callback, &user_data);
+    return read_file_result(error, LEXY_MOV(user_data.buffer));
+}
+
+/// Reads the files at the specified paths into buffers.
+/// Invokes `fn(index, result)` for each file as soon as it has been read, which is not necessarily
+/// in the order of the paths.
+template <typename Encoding          = default_encoding,
+          encoding_endianness Endian = encoding_endianness::bom, typename MemoryResource = void,
+          typename Fn>
+void read_files(const char* const* paths, std::size_t count, Fn fn,
+                MemoryResource* resource = _detail::get_memory_resource<MemoryResource>())
+{
+    using result_type = read_file_result<Encoding, MemoryResource>;
+    struct user_data_t
+    {
+        Fn*             fn;
+        MemoryResource* resource;
+    } user_data{&fn, resource};
+
+    auto callback = [](void* _user_data, std::size_t index, file_error ec, const char* memory,
+                       std::size_t size) {
+        auto user_data = static_cast<user_data_t*>(_user_data);
+        if (ec == file_error::_success)
+            (*user_data->fn)(index, result_type(ec, lexy::make_buffer_from_raw<Encoding, Endian>(
+                                                        memory, size, user_data->resource)));
+        else
+            (*user_data->fn)(index, result_type(ec, user_data->resource));
+    };
+    _detail::read_files(paths, count, callback, &user_data);
+}
+
 /// Reads stdin into a buffer.
 template <typename Encoding          = default_encoding,
           encoding_endianness Endian = encoding_endianness::bom, typename MemoryResource = void>
@@ -0,0 +1,402 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef LEXY_MEMORY_RESOURCE_HPP_INCLUDED
+#define LEXY_MEMORY_RESOURCE_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <lexy/_detail/assert.hpp>
+#include <lexy/_detail/config.hpp>
+#include <lexy/_detail/memory_resource.hpp>
+
+namespace lexy
+{
+/// A memory resource that hands out memory by bumping a pointer in big chunks.
+///
+/// Deallocation does nothing, unless it is the most recent allocation.
+/// Instead, `reset()` makes all memory available again while keeping the chunks,
+/// and `release()` or the destructor returns the chunks to the upstream resource.
+template <typename UpstreamResource = void>
+class arena_resource
+{
+public:
+    static constexpr std::size_t default_chunk_size = 4 * 1024;
+    /// Chunks stop growing once they reach this size.
+    static constexpr std::size_t max_chunk_size = 64 * 1024 * 1024;
+
+    explicit arena_resource(std::size_t       initial_chunk_size = default_chunk_size,
+                            UpstreamResource* upstream
+                            = _detail::get_memory_resource<UpstreamResource>()) noexcept
+    : _upstream(upstream), _head(nullptr), _cur(nullptr), _pos(nullptr), _end(nullptr),
+      _initial_chunk_size(initial_chunk_size), _next_chunk_size(initial_chunk_size)
+    {
+        LEXY_PRECONDITION(initial_chunk_size > sizeof(_chunk));
+    }
+    explicit arena_resource(UpstreamResource* upstream) noexcept
+    : arena_resource(default_chunk_size, upstream)
+    {}
+
+    arena_resource(const arena_resource&) = delete;
+    arena_resource& operator=(const arena_resource&) = delete;
+
+    ~arena_resource() noexcept
+    {
+        release();
+    }
+
+    UpstreamResource* upstream() const noexcept
+    {
+        return _upstream.get();
+    }
+
+    //=== allocation ===//
+    void* allocate(std::size_t bytes, std::size_t alignment)
+    {
+        auto offset = _align_offset(_pos, alignment);
+        if (_cur == nullptr || std::size_t(_end - _pos) < offset + bytes)
+            return _allocate_slow(bytes, alignment);
+
+        auto memory = _pos + offset;
+        _pos        = memory + bytes;
+        return memory;
+    }
+
+    void deallocate(void* ptr, std::size_t bytes, std::size_t) noexcept
+    {
+        // If it is the most recent allocation, we can reuse the memory.
+        if (static_cast<unsigned char*>(ptr) + bytes == _pos)
+            _pos = static_cast<unsigned char*>(ptr);
+    }
+
+    /// Makes the memory of all chunks available again, without returning them to the upstream.
+    /// All memory previously allocated from the arena is invalidated.
+    void reset() noexcept
+    {
+        _cur = _head;
+        if (_cur == nullptr)
+        {
+            _pos = _end = nullptr;
+        }
+        else
+        {
+            _pos = _cur->memory();
+            _end = _cur->end();
+        }
+    }
+
+    /// Returns all chunks to the upstream resource, so the next chunk has the initial size again.
+    /// All memory previously allocated from the arena is invalidated.
+    void release() noexcept
+    {
+        while (_head != nullptr)
+        {
+            auto next = _head->next;
+            _upstream->deallocate(_head, _head->size, alignof(_chunk));
+            _head = next;
+        }
+        reset();
+        _next_chunk_size = _initial_chunk_size;
+    }
+
+    friend bool operator==(const arena_resource& lhs, const arena_resource& rhs) noexcept
+    {
+        return &lhs == &rhs;
+    }
+
+private:
+    struct alignas(std::max_align_t) _chunk
+    {
+        _chunk*     next;
+        std::size_t size; // including the header
+
+        unsigned char* memory() noexcept
+        {
+            return reinterpret_cast<unsigned char*>(this + 1);
+        }
+        unsigned char* end() noexcept
+        {
+            return reinterpret_cast<unsigned char*>(this) + size;
+        }
+    };
+
+    static std::size_t _align_offset(const unsigned char* ptr, std::size_t alignment) noexcept
+    {
+        LEXY_PRECONDITION(alignment > 0 && (alignment & (alignment - 1)) == 0);
+        return std::size_t(-reinterpret_cast<std::uintptr_t>(ptr)) & (alignment - 1);
+    }
+
+    void* _allocate_slow(std::size_t bytes, std::size_t alignment)
+    {
+        // The next chunk is either one we had before the last reset, or a new one.
+        auto next = _cur == nullptr ? _head : _cur->next;
+        if (next == nullptr || std::size_t(next->end() - next->memory())
+                                   < _align_offset(next->memory(), alignment) + bytes)
+        {
+            // We insert a new chunk in front of it, which is big enough for the allocation.
+            auto min_size = sizeof(_chunk) + bytes + alignment;
+            auto size     = _next_chunk_size < min_size ? min_size : _next_chunk_size;
+
+            auto memory  = _upstream->allocate(size, alignof(_chunk));
+            auto chunk   = ::new (memory) _chunk{next, size};
+            if (_next_chunk_size <= max_chunk_size / 2)
+                _next_chunk_size *= 2;
+
+            if (_cur == nullptr)
+                _head = chunk;
+            else
+                _cur->next = chunk;
+            next = chunk;
+        }
+
+        _cur = next;
+        _pos = _cur->memory();
+        _end = _cur->end();
+        return allocate(bytes, alignment);
+    }
+
+    LEXY_EMPTY_MEMBER _detail::memory_resource_ptr<UpstreamResource> _upstream;
+    _chunk*                                                          _head;
+    _chunk*                                                          _cur;
+    unsigned char*                                                   _pos;
+    unsigned char*                                                   _end;
+    std::size_t                                                      _initial_chunk_size;
+    std::size_t                                                      _next_chunk_size;
+};
+} // namespace lexy
+
+namespace lexy
+{
+/// Statistics of a `pooled_resource`.
+struct pool_stats
+{
+    /// The number of allocations that reused a cached block.
+    std::size_t hits;
+    /// The number of allocations that were forwarded to the upstream resource.
+    std::size_t misses;
+    /// The total size of all cached blocks.
+    std::size_t bytes_cached;
+};
+
+/// A memory resource that caches freed blocks to reuse them for the next allocation of a similar
+/// size, e.g. the buffers of repeated `lexy::read_file()` calls.
+///
+/// Blocks are grouped into size classes, four for each power of two.
+/// It is not thread-safe, so use one per thread, e.g. as a `thread_local` variable.
+template <typename UpstreamResource = void>
+class pooled_resource
+{
+public:
+    static constexpr std::size_t default_max_cached_bytes = 64 * 1024 * 1024;
+
+    explicit pooled_resource(std::size_t       max_cached_bytes = default_max_cached_bytes,
+                             UpstreamResource* upstream
+                             = _detail::get_memory_resource<UpstreamResource>()) noexcept
+    : _upstream(upstream), _free{}, _stats{0, 0, 0}, _max_cached_bytes(max_cached_bytes)
+    {}
+    explicit pooled_resource(UpstreamResource* upstream) noexcept
+    : pooled_resource(default_max_cached_bytes, upstream)
+    {}
+
+    pooled_resource(const pooled_resource&) = delete;
+    pooled_resource& operator=(const pooled_resource&) = delete;
+
+    ~pooled_resource() noexcept
+    {
+        trim();
+    }
+
+    UpstreamResource* upstream() const noexcept
+    {
+        return _upstream.get();
+    }
+
+    //=== allocation ===//
+    void* allocate(std::size_t bytes, std::size_t alignment)
+    {
+        if (alignment > alignof(std::max_align_t) || bytes > _max_class_size)
+        {
+            ++_stats.misses;
+            return _upstream->allocate(bytes, alignment);
+        }
+
+        auto cls = _size_class(bytes);
+        if (auto block = _free[cls])
+        {
+            _free[cls] = block->next;
+            _stats.bytes_cached -= _class_size(cls);
+            ++_stats.hits;
+            return block;
+        }
+
+        ++_stats.misses;
+        return _upstream->allocate(_class_size(cls), alignof(std::max_align_t));
+    }
+
+    void deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept
+    {
+        if (alignment > alignof(std::max_align_t) || bytes > _max_class_size)
+        {
+            _upstream->deallocate(ptr, bytes, alignment);
+            return;
+        }
+
+        auto cls  = _size_class(bytes);
+        auto size = _class_size(cls);
+        if (_stats.bytes_cached + size > _max_cached_bytes)
+        {
+            _upstream->deallocate(ptr, size, alignof(std::max_align_t));
+            return;
+        }
+
+        _free[cls] = ::new (ptr) _block{_free[cls]};
+        _stats.bytes_cached += size;
+    }
+
+    pool_stats stats() const noexcept
+    {
+        return _stats;
+    }
+
+    /// Returns cached blocks to the upstream resource, starting with the biggest ones, until
+    /// at most `max_bytes` are cached, e.g. in response to memory pressure.
+    void trim(std::size_t max_bytes = 0) noexcept
+    {
+        for (auto cls = _class_count; cls > 0 && _stats.bytes_cached > max_bytes; --cls)
+        {
+            auto& list = _free[cls - 1];
+            while (list != nullptr && _stats.bytes_cached > max_bytes)
+            {
+                auto block = list;
+                list       = block->next;
+
+                _upstream->deallocate(block, _class_size(cls - 1), alignof(std::max_align_t));
+                _stats.bytes_cached -= _class_size(cls - 1);
+            }
+        }
+    }
+
+    friend bool operator==(const pooled_resource& lhs, const pooled_resource& rhs) noexcept
+    {
+        return &lhs == &rhs;
+    }
+
+private:
+    struct _block
+    {
+        _block* next;
+    };
+
+    // The smallest class is 2^_min_shift, then there are four classes up to the next power.
+    static constexpr std::size_t _min_shift      = 6;
+    static constexpr std::size_t _max_shift      = sizeof(std::size_t) * 8 - 2;
+    static constexpr std::size_t _class_count    = 1 + 4 * (_max_shift - _min_shift);
+    static constexpr std::size_t _max_class_size = std::size_t(1) << _max_shift;
+
+    static std::size_t _size_class(std::size_t bytes) noexcept
+    {
+        if (bytes <= (std::size_t(1) << _min_shift))
+            return 0;
+
+        // Find the power of two e with 2^e < bytes <= 2^(e + 1).
+        auto e = _min_shift;
+        while ((std::size_t(1) << (e + 1)) < bytes)
+            ++e;
+
+        // Round up to the next quarter step of that range.
+        auto quarter = std::size_t(1) << (e - 2);
+        auto k       = (bytes - (std::size_t(1) << e) + quarter - 1) / quarter;
+        return 1 + 4 * (e - _min_shift) + (k - 1);
+    }
+    static std::size_t _class_size(std::size_t cls) noexcept
+    {
+        if (cls == 0)
+            return std::size_t(1) << _min_shift;
+
+        auto e = (cls - 1) / 4 + _min_shift;
+        auto k = (cls - 1) % 4 + 1;
+        return (std::size_t(1) << e) + k * (std::size_t(1) << (e - 2));
+    }
+
+    LEXY_EMPTY_MEMBER _detail::memory_resource_ptr<UpstreamResource> _upstream;
+    _block*                                                          _free[_class_count];
+    pool_stats                                                       _stats;
+    std::size_t                                                      _max_cached_bytes;
+};
+} // namespace lexy
+
+namespace lexy
+{
+/// An allocator that allocates from a memory resource, for containers created during parsing.
+template <typename T, typename MemoryResource = void>
+class resource_allocator
+{
+public:
+    using value_type = T;
+
+    resource_allocator(MemoryResource* resource
+                       = _detail::get_memory_resource<MemoryResource>()) noexcept
+    : _resource(resource)
+    {}
+
+    template <typename U>
+    resource_allocator(const resource_allocator<U, MemoryResource>& other) noexcept
+    : _resource(other.resource())
+    {}
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(_resource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept
+    {
+        _resource->deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+
+    MemoryResource* resource() const noexcept
+    {
+        return _resource.get();
+    }
+
+    friend bool operator==(const resource_allocator& lhs, const resource_allocator& rhs) noexcept
+    {
+        return *lhs._resource == *rhs._resource;
+    }
+    friend bool operator!=(const resource_allocator& lhs, const resource_allocator& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    LEXY_EMPTY_MEMBER _detail::memory_resource_ptr<MemoryResource> _resource;
+};
+
+/// A parse state that makes a memory resource available to the value callbacks.
+template <typename MemoryResource>
+class arena_state
+{
+public:
+    constexpr explicit arena_state(MemoryResource& resource) noexcept : _resource(&resource) {}
+
+    constexpr MemoryResource* memory_resource() const noexcept
+    {
+        return _resource;
+    }
+
+private:
+    MemoryResource* _resource;
+};
+
+/// Creates a parse state so that `lexy::new_`, `lexy::as_list`, `lexy::as_collection` and
+/// `lexy::as_string` allocate from the resource.
+template <typename MemoryResource>
+constexpr auto with_arena(MemoryResource& resource) noexcept
+{
+    return arena_state<MemoryResource>(resource);
+}
+} // namespace lexy
+
+#endif // LEXY_MEMORY_RESOURCE_HPP_INCLUDED
+
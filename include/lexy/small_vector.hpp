@@ -0,0 +1,317 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef LEXY_SMALL_VECTOR_HPP_INCLUDED
+#define LEXY_SMALL_VECTOR_HPP_INCLUDED
+
+#include <cstddef>
+#include <lexy/_detail/assert.hpp>
+#include <lexy/_detail/config.hpp>
+#include <lexy/_detail/memory_resource.hpp>
+#include <new>
+#include <type_traits>
+
+namespace lexy
+{
+/// A vector that stores the first `N` elements inline, without allocating memory.
+///
+/// It only provides the subset of the `std::vector` interface that is useful for the result of
+/// a parse.
+template <typename T, std::size_t N>
+class small_vector
+{
+    static_assert(N > 0, "use std::vector instead");
+
+public:
+    using value_type      = T;
+    using size_type       = std::size_t;
+    using reference       = T&;
+    using const_reference = const T&;
+    using iterator        = T*;
+    using const_iterator  = const T*;
+
+    static constexpr std::size_t inline_capacity = N;
+
+    //=== constructors ===//
+    small_vector() noexcept : _data(_inline_data()), _size(0), _capacity(N) {}
+
+    small_vector(const small_vector& other) : small_vector()
+    {
+        reserve(other._size);
+        for (auto& elem : other)
+            ::new (static_cast<void*>(_data + _size++)) T(elem);
+    }
+    small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    : small_vector()
+    {
+        _steal(other);
+    }
+
+    ~small_vector() noexcept
+    {
+        clear();
+        _deallocate();
+    }
+
+    small_vector& operator=(const small_vector& other)
+    {
+        if (this != &other)
+        {
+            clear();
+            reserve(other._size);
+            for (auto& elem : other)
+                ::new (static_cast<void*>(_data + _size++)) T(elem);
+        }
+        return *this;
+    }
+    small_vector& operator=(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this != &other)
+        {
+            clear();
+            _deallocate();
+            _data     = _inline_data();
+            _capacity = N;
+            _steal(other);
+        }
+        return *this;
+    }
+
+    //=== access ===//
+    bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+    std::size_t size() const noexcept
+    {
+        return _size;
+    }
+    std::size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+    static constexpr std::size_t max_size() noexcept
+    {
+        return std::size_t(-1) / sizeof(T);
+    }
+
+    /// Whether the elements are stored inline.
+    bool is_inline() const noexcept
+    {
+        return _data == _inline_data();
+    }
+
+    T* data() noexcept
+    {
+        return _data;
+    }
+    const T* data() const noexcept
+    {
+        return _data;
+    }
+
+    iterator begin() noexcept
+    {
+        return _data;
+    }
+    iterator end() noexcept
+    {
+        return _data + _size;
+    }
+    const_iterator begin() const noexcept
+    {
+        return _data;
+    }
+    const_iterator end() const noexcept
+    {
+        return _data + _size;
+    }
+
+    T& operator[](std::size_t idx) noexcept
+    {
+        LEXY_PRECONDITION(idx < _size);
+        return _data[idx];
+    }
+    const T& operator[](std::size_t idx) const noexcept
+    {
+        LEXY_PRECONDITION(idx < _size);
+        return _data[idx];
+    }
+
+    T& front() noexcept
+    {
+        return (*this)[0];
+    }
+    const T& front() const noexcept
+    {
+        return (*this)[0];
+    }
+    T& back() noexcept
+    {
+        return (*this)[_size - 1];
+    }
+    const T& back() const noexcept
+    {
+        return (*this)[_size - 1];
+    }
+
+    //=== modifiers ===//
+    void reserve(std::size_t new_capacity)
+    {
+        if (new_capacity <= _capacity)
+            return;
+        else if (new_capacity > max_size())
+            throw std::bad_array_new_length();
+
+        auto memory = _allocate(new_capacity);
+        _relocate(memory);
+        _deallocate();
+        _data     = memory;
+        _capacity = new_capacity;
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        if (_size == _capacity)
+        {
+            if (_capacity == max_size())
+                throw std::bad_array_new_length();
+            auto new_capacity = _capacity <= max_size() / 2 ? 2 * _capacity : max_size();
+
+            // We construct the new element before moving the existing ones,
+            // as the arguments might refer to them.
+            // If that throws, the guard deallocates the new memory again.
+            _allocation_guard guard{_allocate(new_capacity), new_capacity};
+            ::new (static_cast<void*>(guard.memory + _size)) T(LEXY_FWD(args)...);
+            auto memory  = guard.memory;
+            guard.memory = nullptr;
+
+            _relocate(memory);
+            _deallocate();
+            _data     = memory;
+            _capacity = new_capacity;
+        }
+        else
+        {
+            ::new (static_cast<void*>(_data + _size)) T(LEXY_FWD(args)...);
+        }
+
+        return _data[_size++];
+    }
+
+    void push_back(const T& obj)
+    {
+        emplace_back(obj);
+    }
+    void push_back(T&& obj)
+    {
+        emplace_back(LEXY_MOV(obj));
+    }
+
+    void pop_back() noexcept
+    {
+        LEXY_PRECONDITION(_size > 0);
+        _data[--_size].~T();
+    }
+
+    /// Destroys all elements, but keeps the memory.
+    void clear() noexcept
+    {
+        for (auto i = std::size_t(0); i != _size; ++i)
+            _data[i].~T();
+        _size = 0;
+    }
+
+    friend bool operator==(const small_vector& lhs, const small_vector& rhs)
+    {
+        if (lhs._size != rhs._size)
+            return false;
+
+        for (auto i = std::size_t(0); i != lhs._size; ++i)
+            if (!(lhs._data[i] == rhs._data[i]))
+                return false;
+        return true;
+    }
+    friend bool operator!=(const small_vector& lhs, const small_vector& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    T* _inline_data() noexcept
+    {
+        return reinterpret_cast<T*>(_inline);
+    }
+    const T* _inline_data() const noexcept
+    {
+        return reinterpret_cast<const T*>(_inline);
+    }
+
+    struct _allocation_guard
+    {
+        T*          memory;
+        std::size_t capacity;
+
+        ~_allocation_guard() noexcept
+        {
+            if (memory != nullptr)
+                _detail::default_memory_resource::deallocate(memory, capacity * sizeof(T),
+                                                             alignof(T));
+        }
+    };
+
+    static T* _allocate(std::size_t capacity)
+    {
+        auto memory
+            = _detail::default_memory_resource::allocate(capacity * sizeof(T), alignof(T));
+        return static_cast<T*>(memory);
+    }
+    void _deallocate() noexcept
+    {
+        if (!is_inline())
+            _detail::default_memory_resource::deallocate(_data, _capacity * sizeof(T),
+                                                         alignof(T));
+    }
+
+    // Moves all elements to the new memory and destroys the old ones; does not change `_size`.
+    void _relocate(T* memory) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        for (auto i = std::size_t(0); i != _size; ++i)
+        {
+            ::new (static_cast<void*>(memory + i)) T(LEXY_MOV(_data[i]));
+            _data[i].~T();
+        }
+    }
+
+    // Takes the elements of other, which must be empty afterwards; `*this` must be inline.
+    void _steal(small_vector& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (other.is_inline())
+        {
+            other._relocate(_data);
+            _size = other._size;
+        }
+        else
+        {
+            // We can take the memory.
+            _data     = other._data;
+            _size     = other._size;
+            _capacity = other._capacity;
+
+            other._data     = other._inline_data();
+            other._capacity = N;
+        }
+        other._size = 0;
+    }
+
+    T*          _data;
+    std::size_t _size;
+    std::size_t _capacity;
+    alignas(T) unsigned char _inline[N * sizeof(T)];
+};
+} // namespace lexy
+
+#endif // LEXY_SMALL_VECTOR_HPP_INCLUDED
+
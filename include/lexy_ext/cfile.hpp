@@ -58,6 +58,35 @@ template <typename Encoding                = lexy::default_encoding,
         builder.grow();
     }
 
+    if constexpr (std::is_same_v<MemoryResource, lexy::huge_page_resource>
+                  && sizeof(typename Encoding::char_type) == 1)
+    {
+        // If the builder has mapped its memory the same way the resource does,
+        // we can give it to the buffer instead of copying it.
+        // This requires that the input doesn't need to be changed, i.e. no BOM is stripped.
+        using buffer_type = lexy::buffer<Encoding, MemoryResource>;
+        using char_type   = typename buffer_type::char_type;
+
+        auto data    = reinterpret_cast<const unsigned char*>(builder.read_data());
+        auto size    = builder.read_size();
+        auto has_bom = size >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF;
+        if ((Endian != lexy::encoding_endianness::bom || !has_bom) && builder.is_mapped())
+        {
+            // The library unmaps exactly that many bytes; zero if it doesn't use mappings.
+            auto mapping_size
+                = lexy::_detail::huge_page_mapping_size(buffer_type::allocation_size(size));
+            if (mapping_size != 0)
+            {
+                LEXY_ASSERT(mapping_size >= buffer_type::allocation_size(size),
+                            "mapping does not cover the buffer");
+                auto memory = builder.release_mapping(mapping_size);
+                auto buffer
+                    = buffer_type::adopt(reinterpret_cast<char_type*>(memory), size, resource);
+                return result_type(lexy::file_error::_success, LEXY_MOV(buffer));
+            }
+        }
+    }
+
     auto buffer = lexy::make_buffer_from_raw<Encoding, Endian>(builder.read_data(),
                                                                builder.read_size(), resource);
     return result_type(lexy::file_error::_success, LEXY_MOV(buffer));
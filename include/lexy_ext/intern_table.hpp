@@ -0,0 +1,246 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef LEXY_EXT_INTERN_TABLE_HPP_INCLUDED
+#define LEXY_EXT_INTERN_TABLE_HPP_INCLUDED
+
+#include <cstdint>
+#include <lexy/encoding.hpp>
+#include <lexy/lexeme.hpp>
+#include <lexy/memory_resource.hpp>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lexy_ext
+{
+/// The id of a string in an `intern_table`.
+enum class interned_id : std::uint32_t
+{
+};
+
+/// A thread-safe table that stores each distinct string once and identifies it by a compact id.
+///
+/// The table is split into `ShardCount` independent shards, selected by the hash of the string,
+/// so parsers running on different threads rarely wait for each other.
+/// The strings are stored in an arena per shard, whose chunks are allocated from the resource.
+template <typename Encoding = lexy::default_encoding, typename MemoryResource = void,
+          std::size_t ShardCount = 16>
+class intern_table
+{
+    static_assert(ShardCount > 0 && (ShardCount & (ShardCount - 1)) == 0,
+                  "shard count must be a power of two");
+
+public:
+    using encoding  = Encoding;
+    using char_type = typename encoding::char_type;
+
+    explicit intern_table(MemoryResource* resource
+                          = lexy::_detail::get_memory_resource<MemoryResource>())
+    {
+        for (auto& shard : _shards)
+            shard = std::make_unique<_shard>(resource);
+    }
+
+    intern_table(const intern_table&) = delete;
+    intern_table& operator=(const intern_table&) = delete;
+
+    //=== intern ===//
+    /// Returns the id of the string, adding it to the table if necessary.
+    template <typename Iterator>
+    interned_id intern(Iterator begin, Iterator end)
+    {
+        // Hash the string using FNV-1a and determine its length.
+        auto hash = std::uint64_t(14695981039346656037ull);
+        auto size = std::size_t(0);
+        for (auto iter = begin; iter != end; ++iter)
+        {
+            hash ^= static_cast<std::uint64_t>(encoding::to_int_type(*iter));
+            hash *= std::uint64_t(1099511628211ull);
+            ++size;
+        }
+
+        auto  shard_idx = std::size_t(hash & (ShardCount - 1));
+        auto& shard     = *_shards[shard_idx];
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto&                       slot = shard.find(hash, begin, end, size);
+        if (slot == 0)
+            shard.insert(slot, hash, begin, size);
+        auto index = slot - 1;
+
+        if (2 * shard.entries.size() > shard.slots.size())
+            shard.rehash();
+
+        auto id = index * ShardCount + shard_idx;
+        LEXY_PRECONDITION(id <= UINT32_MAX);
+        return interned_id(std::uint32_t(id));
+    }
+
+    interned_id intern(const char_type* str, std::size_t size)
+    {
+        return intern(str, str + size);
+    }
+
+    //=== access ===//
+    /// The null-terminated string with the id.
+    const char_type* c_str(interned_id id) const
+    {
+        auto& shard = _shard_of(id);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.entries[_index_of(id)].data;
+    }
+
+    /// The length of the string with the id.
+    std::size_t length(interned_id id) const
+    {
+        auto& shard = _shard_of(id);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.entries[_index_of(id)].size;
+    }
+
+    /// The number of distinct strings in the table.
+    std::size_t size() const
+    {
+        auto result = std::size_t(0);
+        for (auto& shard : _shards)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            result += shard->entries.size();
+        }
+        return result;
+    }
+
+private:
+    struct _entry
+    {
+        const char_type* data;
+        std::size_t      size;
+        std::uint64_t    hash;
+    };
+
+    // Aligned to avoid false sharing between the mutexes of different shards.
+    struct alignas(64) _shard
+    {
+        mutable std::mutex                   mutex;
+        lexy::arena_resource<MemoryResource> arena;
+        std::vector<_entry>                  entries;
+        // Open addressing with linear probing; stores the index into entries + 1, or 0 if empty.
+        std::vector<std::size_t> slots;
+
+        explicit _shard(MemoryResource* resource) : arena(resource), slots(64) {}
+
+        template <typename Iterator>
+        std::size_t& find(std::uint64_t hash, Iterator begin, Iterator end, std::size_t size)
+        {
+            // The lower bits of the hash determine the shard, so we use the upper ones.
+            auto mask = slots.size() - 1;
+            for (auto idx = std::size_t(hash >> 32) & mask;; idx = (idx + 1) & mask)
+            {
+                auto& slot = slots[idx];
+                if (slot == 0)
+                    return slot;
+
+                auto& entry = entries[slot - 1];
+                if (entry.hash == hash && entry.size == size && _equal(entry.data, begin, end))
+                    return slot;
+            }
+        }
+
+        template <typename Iterator>
+        void insert(std::size_t& slot, std::uint64_t hash, Iterator begin, std::size_t size)
+        {
+            auto memory = static_cast<char_type*>(
+                arena.allocate((size + 1) * sizeof(char_type), alignof(char_type)));
+            auto ptr = memory;
+            for (auto i = std::size_t(0); i != size; ++i)
+                *ptr++ = *begin++;
+            *ptr = char_type();
+
+            entries.push_back({memory, size, hash});
+            slot = entries.size();
+        }
+
+        void rehash()
+        {
+            std::vector<std::size_t> new_slots(2 * slots.size());
+            auto                     mask = new_slots.size() - 1;
+            for (auto i = std::size_t(0); i != entries.size(); ++i)
+            {
+                auto idx = std::size_t(entries[i].hash >> 32) & mask;
+                while (new_slots[idx] != 0)
+                    idx = (idx + 1) & mask;
+                new_slots[idx] = i + 1;
+            }
+            slots = LEXY_MOV(new_slots);
+        }
+
+        template <typename Iterator>
+        static bool _equal(const char_type* str, Iterator begin, Iterator end)
+        {
+            for (auto iter = begin; iter != end; ++iter, ++str)
+                if (*str != *iter)
+                    return false;
+            return true;
+        }
+    };
+
+    const _shard& _shard_of(interned_id id) const noexcept
+    {
+        return *_shards[std::size_t(id) & (ShardCount - 1)];
+    }
+    static std::size_t _index_of(interned_id id) noexcept
+    {
+        return std::size_t(id) / ShardCount;
+    }
+
+    std::unique_ptr<_shard> _shards[ShardCount];
+};
+} // namespace lexy_ext
+
+namespace lexy_ext
+{
+template <typename Table>
+struct _interned
+{
+    Table* _table;
+
+    using return_type = interned_id;
+
+    constexpr interned_id operator()(interned_id id) const
+    {
+        return id;
+    }
+
+    template <typename Reader>
+    interned_id operator()(lexy::lexeme<Reader> lex) const
+    {
+        static_assert(lexy::char_type_compatible_with_reader<Reader,
+                                                             typename Table::char_type>,
+                      "lexeme has an incompatible character type");
+        return _table->intern(lex.begin(), lex.end());
+    }
+
+    /// Interns a null-terminated string, e.g. the value of a `dsl::symbol`.
+    interned_id operator()(const typename Table::char_type* str) const
+    {
+        auto end = str;
+        while (*end != typename Table::char_type())
+            ++end;
+        return _table->intern(str, end);
+    }
+};
+
+/// A callback that interns the lexeme in the table and returns its id.
+template <typename Encoding, typename MemoryResource, std::size_t ShardCount>
+constexpr auto as_interned(intern_table<Encoding, MemoryResource, ShardCount>& table)
+{
+    return _interned<intern_table<Encoding, MemoryResource, ShardCount>>{&table};
+}
+} // namespace lexy_ext
+
+#endif // LEXY_EXT_INTERN_TABLE_HPP_INCLUDED
+
@@ -0,0 +1,225 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef LEXY_EXT_LAZY_PARSE_TREE_HPP_INCLUDED
+#define LEXY_EXT_LAZY_PARSE_TREE_HPP_INCLUDED
+
+#include <lexy/action/parse_as_tree.hpp>
+#include <lexy/parse_tree.hpp>
+#include <unordered_map>
+
+namespace lexy_ext
+{
+template <typename LazyTree, typename Input, typename RootProduction, typename ErrorCallback>
+class _lazy_pt_handler;
+
+/// A parse tree where productions with a `deferred` token rule are only parsed once their children
+/// are requested.
+template <typename Input, typename TokenKind = void, typename MemoryResource = void>
+class lazy_parse_tree
+{
+public:
+    using tree_type = lexy::parse_tree_for<Input, TokenKind, MemoryResource>;
+    using node      = typename tree_type::node;
+
+    //=== construction ===//
+    lazy_parse_tree() : lazy_parse_tree(lexy::_detail::get_memory_resource<MemoryResource>()) {}
+    explicit lazy_parse_tree(MemoryResource* resource)
+    : _resource(resource), _tree(resource), _input(nullptr), _error_count(0)
+    {}
+
+    //=== access ===//
+    bool empty() const noexcept
+    {
+        return _tree.empty();
+    }
+
+    /// The tree of the top-level production; deferred productions are not expanded.
+    const tree_type& shallow_tree() const noexcept
+    {
+        return _tree;
+    }
+
+    node root() const noexcept
+    {
+        return _tree.root();
+    }
+
+    void clear() noexcept
+    {
+        _tree.clear();
+        _registry.clear();
+        _expansions.clear();
+        _input       = nullptr;
+        _error_count = 0;
+    }
+
+    //=== expansion ===//
+    /// Whether the node is a production that has been skipped over.
+    bool is_deferred(node n) const noexcept
+    {
+        auto kind = n.kind();
+        // The root of an expansion is the deferred production, but it is no longer deferred.
+        return kind.is_production() && !kind.is_root() && _registry.count(kind.name()) != 0;
+    }
+
+    bool is_expanded(node n) const noexcept
+    {
+        return _expansions.count(n.address()) != 0;
+    }
+
+    /// Parses the deferred production, if that hasn't happened yet.
+    /// Returns the tree whose root is the production; it is empty if parsing failed.
+    const tree_type& expand(node n)
+    {
+        LEXY_PRECONDITION(is_deferred(n));
+
+        auto iter = _expansions.find(n.address());
+        if (iter == _expansions.end())
+        {
+            iter = _expansions.emplace(n.address(), tree_type(_resource)).first;
+
+            // The single child of a deferred production is the token that contains its extent.
+            auto token = *n.children().begin();
+            auto fn    = _registry.find(n.kind().name())->second;
+            _error_count += fn(*this, iter->second, token.lexeme().begin());
+        }
+
+        return iter->second;
+    }
+
+    /// Returns the children of the node, expanding it first if necessary.
+    /// If the expansion failed, returns the single token of the deferred production.
+    auto children(node n)
+    {
+        if (is_deferred(n))
+        {
+            auto& tree = expand(n);
+            if (!tree.empty())
+                return tree.root().children();
+        }
+
+        return n.children();
+    }
+
+    /// The number of errors raised while expanding deferred productions.
+    std::size_t expansion_error_count() const noexcept
+    {
+        return _error_count;
+    }
+
+private:
+    using _iterator  = typename lexy::input_reader<Input>::iterator;
+    using _expand_fn = std::size_t (*)(lazy_parse_tree&, tree_type&, _iterator);
+
+    template <typename Production, typename RootProduction>
+    static std::size_t _expand(lazy_parse_tree& self, tree_type& result, _iterator begin)
+    {
+        using handler_t = _lazy_pt_handler<lazy_parse_tree, Input, RootProduction, lexy::_noop>;
+
+        auto reader  = self._input->reader();
+        auto handler = handler_t(self, result, *self._input, lexy::noop);
+        reader.set_position(begin);
+        return lexy::do_action<Production, RootProduction>(LEXY_MOV(handler), lexy::no_parse_state,
+                                                           reader)
+            .error_count();
+    }
+
+    template <typename Production, typename RootProduction>
+    void _register()
+    {
+        _registry.emplace(lexy::production_name<Production>(),
+                          &_expand<Production, RootProduction>);
+    }
+
+    MemoryResource* _resource;
+    tree_type       _tree;
+    const Input*    _input;
+
+    std::unordered_map<const char*, _expand_fn> _registry;
+    std::unordered_map<const void*, tree_type>  _expansions;
+    std::size_t                                 _error_count;
+
+    template <typename, typename, typename, typename>
+    friend class _lazy_pt_handler;
+    template <typename Production, typename I, typename TK, typename MR, typename ErrorCallback>
+    friend auto parse_as_lazy_tree(lazy_parse_tree<I, TK, MR>&, const I&, const ErrorCallback&)
+        -> lexy::validate_result<ErrorCallback>;
+};
+
+// Wraps the regular parse tree handler to register the deferred productions with the lazy tree.
+template <typename LazyTree, typename Input, typename RootProduction, typename ErrorCallback>
+class _lazy_pt_handler
+{
+    using tree_type = typename LazyTree::tree_type;
+    using base      = lexy::parse_tree_handler<tree_type, Input, ErrorCallback,
+                                          lexy::deferred_parse_tree>;
+
+public:
+    explicit _lazy_pt_handler(LazyTree& lazy, tree_type& tree, const Input& input,
+                              const ErrorCallback& cb)
+    : _base(tree, input, cb), _lazy(&lazy)
+    {}
+
+    template <typename Production>
+    static constexpr bool defer_production = base::template defer_production<Production>;
+
+    template <typename Production>
+    class event_handler
+    {
+        using iterator = typename lexy::input_reader<Input>::iterator;
+
+    public:
+        void on(_lazy_pt_handler& handler, lexy::parse_events::production_start ev, iterator pos)
+        {
+            if constexpr (defer_production<Production>)
+                // Remember how to parse the production later on.
+                handler._lazy->template _register<Production, RootProduction>();
+
+            _base.on(handler._base, ev, pos);
+        }
+
+        template <typename Event, typename... Args>
+        void on(_lazy_pt_handler& handler, Event ev, Args&&... args)
+        {
+            _base.on(handler._base, ev, LEXY_FWD(args)...);
+        }
+
+    private:
+        typename base::template event_handler<Production> _base;
+    };
+
+    template <typename Production, typename State>
+    using value_callback = typename base::template value_callback<Production, State>;
+
+    constexpr auto get_result_void(bool rule_parse_result) &&
+    {
+        return LEXY_MOV(_base).get_result_void(rule_parse_result);
+    }
+
+private:
+    base      _base;
+    LazyTree* _lazy;
+};
+
+/// Parses the production into the lazy tree, skipping over all deferred productions.
+template <typename Production, typename Input, typename TokenKind, typename MemoryResource,
+          typename ErrorCallback>
+auto parse_as_lazy_tree(lazy_parse_tree<Input, TokenKind, MemoryResource>& tree,
+                        const Input& input, const ErrorCallback& callback)
+    -> lexy::validate_result<ErrorCallback>
+{
+    using lazy_t    = lazy_parse_tree<Input, TokenKind, MemoryResource>;
+    using handler_t = _lazy_pt_handler<lazy_t, Input, Production, ErrorCallback>;
+
+    tree.clear();
+    tree._input = &input;
+
+    auto handler = handler_t(tree, tree._tree, input, callback);
+    auto reader  = input.reader();
+    return lexy::do_action<Production>(LEXY_MOV(handler), lexy::no_parse_state, reader);
+}
+} // namespace lexy_ext
+
+#endif // LEXY_EXT_LAZY_PARSE_TREE_HPP_INCLUDED
@@ -0,0 +1,239 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef LEXY_EXT_PARALLEL_PARSE_HPP_INCLUDED
+#define LEXY_EXT_PARALLEL_PARSE_HPP_INCLUDED
+
+#include <iterator>
+#include <lexy/action/parse.hpp>
+#include <lexy/callback/forward.hpp>
+#include <lexy/dsl/choice.hpp>
+#include <lexy/dsl/eof.hpp>
+#include <lexy/dsl/production.hpp>
+#include <lexy/dsl/sequence.hpp>
+#include <lexy/input/string_input.hpp>
+#include <vector>
+
+namespace lexy_ext
+{
+template <typename T, typename ErrorCallback>
+class parallel_parse_result
+{
+public:
+    using value_type     = T;
+    using error_callback = ErrorCallback;
+    using error_type     = typename lexy::validate_result<ErrorCallback>::error_type;
+
+    constexpr explicit operator bool() const noexcept
+    {
+        return is_success();
+    }
+
+    constexpr bool is_success() const noexcept
+    {
+        return _error_count == 0;
+    }
+    constexpr bool is_error() const noexcept
+    {
+        return !is_success();
+    }
+
+    /// The number of records that were parsed, including the ones that failed.
+    constexpr std::size_t record_count() const noexcept
+    {
+        return _record_count;
+    }
+
+    /// The result of the sink, it contains the values of the records that could be parsed.
+    constexpr const T& value() const& noexcept
+    {
+        return _value;
+    }
+    constexpr T&& value() && noexcept
+    {
+        return LEXY_MOV(_value);
+    }
+
+    constexpr std::size_t error_count() const noexcept
+    {
+        return _error_count;
+    }
+
+    /// The errors of all records in input order.
+    /// Counts are added, containers are concatenated.
+    constexpr const error_type& errors() const& noexcept
+    {
+        return _errors;
+    }
+    constexpr error_type&& errors() && noexcept
+    {
+        return LEXY_MOV(_errors);
+    }
+
+private:
+    explicit parallel_parse_result(T&& value, error_type&& errors, std::size_t error_count,
+                                   std::size_t record_count)
+    : _value(LEXY_MOV(value)), _errors(LEXY_MOV(errors)), _error_count(error_count),
+      _record_count(record_count)
+    {}
+
+    T           _value;
+    error_type  _errors;
+    std::size_t _error_count;
+    std::size_t _record_count;
+
+    friend struct _pp_access;
+};
+
+struct _pp_access
+{
+    template <typename Result, typename... Args>
+    static Result make(Args&&... args)
+    {
+        return Result(LEXY_FWD(args)...);
+    }
+};
+
+// The record production is no longer the root, so its whitespace needs to be forwarded.
+template <typename Record, bool = lexy::_detail::is_detected<lexy::_detect_whitespace, Record>>
+struct _pp_record_whitespace
+{};
+template <typename Record>
+struct _pp_record_whitespace<Record, true>
+{
+    static constexpr auto whitespace = Record::whitespace;
+};
+
+// A single record followed by either a separator or the end of the chunk.
+template <typename Record, typename Separator>
+struct _pp_record : _pp_record_whitespace<Record>
+{
+    static LEXY_CONSTEVAL auto name()
+    {
+        return lexy::production_name<Record>();
+    }
+
+    static constexpr auto max_recursion_depth = lexy::max_recursion_depth<Record>();
+
+    static constexpr auto rule  = lexy::dsl::p<Record> + (lexy::dsl::eof | Separator{});
+    static constexpr auto value = lexy::forward<
+        typename lexy::production_value_callback<Record, void>::return_type>;
+};
+
+// Returns the position after the next separator, or the end.
+template <typename Encoding, typename Separator, typename Iterator>
+Iterator _pp_skip_to_separator(Iterator begin, Iterator end)
+{
+    auto reader = lexy::_range_reader<Encoding>(begin, end);
+    while (reader.peek() != Encoding::eof())
+    {
+        if (lexy::try_match_token(Separator{}, reader))
+            break;
+        reader.bump();
+    }
+    return reader.position();
+}
+
+/// Parses a sequence of `Record`s that are separated by `Separator`, e.g. a newline.
+///
+/// The input is split into chunks of about `chunk_size` code units at separators, which are
+/// parsed concurrently using `executor.parallel_for()`.
+/// The values of the records are then passed to the sink in input order.
+/// If a record fails to parse, parsing continues after the next separator.
+///
+/// This requires that the separator cannot occur inside a record, as the input is split without
+/// parsing it, and that the error callback can be invoked concurrently.
+/// Errors are reported with an error context for the entire input, so positions and locations are
+/// the same as if the input were parsed sequentially.
+template <typename Record, typename Input, typename Separator, typename Executor, typename Sink,
+          typename Callback>
+auto parallel_parse(const Input& input, Separator, Executor& executor, const Sink& sink,
+                    const Callback& callback, std::size_t chunk_size = 1024 * 1024)
+{
+    static_assert(lexy::is_token_rule<Separator>, "separator must be a token");
+    LEXY_PRECONDITION(chunk_size > 0);
+
+    using encoding = typename Input::encoding;
+    // We view the entire input as a string, so we can create readers for each chunk that are
+    // compatible with it.
+    auto view      = lexy::string_input<encoding>(input.data(), input.size());
+    using view_t   = decltype(view);
+    using reader   = lexy::input_reader<view_t>;
+    using iterator = typename reader::iterator;
+
+    using record_production = _pp_record<Record, Separator>;
+    using record_result     = decltype(lexy::do_action<record_production>(
+        lexy::parse_handler(view, callback), lexy::no_parse_state, LEXY_DECLVAL(reader&)));
+
+    //=== split ===//
+    std::vector<iterator> boundaries;
+    {
+        auto begin = view.data();
+        auto end   = view.data() + view.size();
+
+        boundaries.push_back(begin);
+        for (auto pos = begin; std::size_t(end - pos) > chunk_size;)
+        {
+            pos = _pp_skip_to_separator<encoding, Separator>(pos + chunk_size, end);
+            if (pos == end)
+                break;
+            boundaries.push_back(pos);
+        }
+        boundaries.push_back(end);
+    }
+
+    //=== parse ===//
+    std::vector<std::vector<record_result>> chunks(boundaries.size() - 1);
+    executor.parallel_for(chunks.size(), [&](std::size_t idx) {
+        auto chunk_end = boundaries[idx + 1];
+        auto reader    = lexy::_range_reader<encoding>(boundaries[idx], chunk_end);
+        while (reader.position() != chunk_end)
+        {
+            auto handler = lexy::parse_handler(view, callback);
+            chunks[idx].push_back(lexy::do_action<record_production>(LEXY_MOV(handler),
+                                                                     lexy::no_parse_state,
+                                                                     reader));
+
+            if (chunks[idx].back().is_fatal_error())
+                // Continue with the next record.
+                reader.set_position(
+                    _pp_skip_to_separator<encoding, Separator>(reader.position(), chunk_end));
+        }
+    });
+
+    //=== merge ===//
+    using value_t    = typename LEXY_DECAY_DECLTYPE(sink.sink())::return_type;
+    using result_t   = parallel_parse_result<value_t, Callback>;
+    using error_type = typename result_t::error_type;
+
+    auto        value_sink = sink.sink();
+    error_type  errors{};
+    std::size_t error_count  = 0;
+    std::size_t record_count = 0;
+    for (auto& chunk : chunks)
+        for (auto& record : chunk)
+        {
+            ++record_count;
+            if constexpr (!std::is_void_v<typename record_result::value_type>)
+                if (record.has_value())
+                    value_sink(LEXY_MOV(record).value());
+
+            if (record.is_error())
+            {
+                error_count += record.error_count();
+                auto&& record_errors = LEXY_MOV(record).errors();
+                if constexpr (std::is_same_v<error_type, std::size_t>)
+                    errors += record_errors;
+                else
+                    errors.insert(errors.end(), std::make_move_iterator(record_errors.begin()),
+                                  std::make_move_iterator(record_errors.end()));
+            }
+        }
+
+    return _pp_access::make<result_t>(LEXY_MOV(value_sink).finish(), LEXY_MOV(errors), error_count,
+                                      record_count);
+}
+} // namespace lexy_ext
+
+#endif // LEXY_EXT_PARALLEL_PARSE_HPP_INCLUDED
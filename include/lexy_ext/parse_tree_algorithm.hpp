@@ -7,6 +7,7 @@
 
 #include <lexy/parse_tree.hpp>
 #include <optional>
+#include <vector>
 
 namespace lexy_ext
 {
@@ -278,5 +279,56 @@ auto node_position(const lexy::parse_tree<Reader, TokenKind, MemoryResource>&
 }
 } // namespace lexy_ext
 
+namespace lexy_ext
+{
+template <typename Node, typename Predicate>
+void _collect_subtrees(std::vector<Node>& result, Node node, Predicate& predicate)
+{
+    if (predicate(node))
+        // We don't look for subtrees of a subtree, it is visited as a whole.
+        result.push_back(node);
+    else
+        for (auto child : node.children())
+            _collect_subtrees(result, child, predicate);
+}
+
+/// Invokes `fn(node)` for every node that matches the predicate, but not for the descendants of a
+/// matching node.
+///
+/// The predicate is interpreted as in `children()`.
+/// The subtrees are collected sequentially, then `fn` is invoked concurrently using
+/// `executor.parallel_for()`, e.g. of a `lexy_ext::thread_pool`.
+/// As the parse tree is only read, `fn` can traverse its subtree without synchronization.
+template <typename Reader, typename TokenKind, typename MemoryResource, typename Predicate,
+          typename Fn, typename Executor>
+void parallel_for_each_subtree(const lexy::parse_tree<Reader, TokenKind, MemoryResource>& tree,
+                               Predicate predicate, Fn fn, Executor& executor)
+{
+    using node_t = typename lexy::parse_tree<Reader, TokenKind, MemoryResource>::node;
+    if (tree.empty())
+        return;
+
+    std::vector<node_t> subtrees;
+    if constexpr (std::is_constructible_v<lexy::token_kind<TokenKind>, Predicate>)
+    {
+        auto pred = [kind = lexy::token_kind<TokenKind>(predicate)](node_t n) {
+            return n.kind() == kind;
+        };
+        _collect_subtrees(subtrees, tree.root(), pred);
+    }
+    else if constexpr (lexy::is_production<Predicate>)
+    {
+        auto pred = [](node_t n) { return n.kind() == Predicate{}; };
+        _collect_subtrees(subtrees, tree.root(), pred);
+    }
+    else
+    {
+        _collect_subtrees(subtrees, tree.root(), predicate);
+    }
+
+    executor.parallel_for(subtrees.size(), [&](std::size_t i) { fn(subtrees[i]); });
+}
+} // namespace lexy_ext
+
 #endif // LEXY_EXT_PARSE_TREE_ALGORITHM_HPP_INCLUDED
 
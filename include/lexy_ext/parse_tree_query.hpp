@@ -0,0 +1,254 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef LEXY_EXT_PARSE_TREE_QUERY_HPP_INCLUDED
+#define LEXY_EXT_PARSE_TREE_QUERY_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstring>
+#include <lexy/parse_tree.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lexy_ext
+{
+/// A compiled query that finds nodes of a parse tree.
+///
+/// A query is a sequence of node names separated by combinators, similar to CSS selectors:
+/// * `a b` matches a `b` that is a descendant of an `a`,
+/// * `a > b` matches a `b` that is a child of an `a`,
+/// * `a + b` matches a `b` that is immediately preceded by a sibling `a`,
+/// * `a ~ b` matches a `b` that is preceded by a sibling `a`.
+///
+/// A name matches a node whose name, i.e. the production name or token kind name, is equal to it,
+/// or ends with `::` followed by it. `*` matches every node.
+class parse_tree_query
+{
+public:
+    /// The maximal number of names in a query.
+    static constexpr std::size_t max_size = 64;
+
+    /// Compiles the query.
+    /// If it is not valid, the query does not match anything.
+    explicit parse_tree_query(const char* query) : _valid(true)
+    {
+        auto cur         = query;
+        auto combinator  = _combinator::descendant;
+        auto skip_spaces = [&] {
+            auto has_spaces = false;
+            while (*cur == ' ')
+            {
+                ++cur;
+                has_spaces = true;
+            }
+            return has_spaces;
+        };
+
+        skip_spaces();
+        while (*cur != '\0')
+        {
+            auto name_begin = cur;
+            while (*cur != '\0' && *cur != ' ' && *cur != '>' && *cur != '+' && *cur != '~')
+                ++cur;
+            if (name_begin == cur || _steps.size() == max_size)
+            {
+                // We either have two combinators in a row, or a leading combinator.
+                _invalidate();
+                return;
+            }
+            _steps.push_back({std::string(name_begin, cur), combinator});
+
+            // Parse the combinator, which is a descendant one if there's only whitespace.
+            auto has_spaces = skip_spaces();
+            if (*cur == '>' || *cur == '+' || *cur == '~')
+            {
+                combinator = *cur == '>'   ? _combinator::child
+                             : *cur == '+' ? _combinator::next_sibling
+                                           : _combinator::subsequent_sibling;
+                ++cur;
+                skip_spaces();
+
+                if (*cur == '\0')
+                {
+                    // Trailing combinator.
+                    _invalidate();
+                    return;
+                }
+            }
+            else if (has_spaces)
+            {
+                combinator = _combinator::descendant;
+            }
+        }
+
+        if (_steps.empty())
+            _invalidate();
+    }
+
+    bool is_valid() const noexcept
+    {
+        return _valid;
+    }
+
+    /// Invokes `fn(node)` for every descendant of `node`, including itself, that matches the query.
+    /// It is done in a single traversal of the subtree.
+    /// Combinators only consider nodes inside the subtree.
+    template <typename Reader, typename TokenKind, typename MemoryResource, typename Fn>
+    void for_each(const lexy::parse_tree<Reader, TokenKind, MemoryResource>&         tree,
+                  typename lexy::parse_tree<Reader, TokenKind, MemoryResource>::node node,
+                  Fn                                                                 fn) const
+    {
+        if (!_valid)
+            return;
+
+        // The set of steps a node matches, given that the preceding ones have been matched.
+        // Bit i is set if the node matches the query up to and including step i.
+        using set = std::uint_least64_t;
+        struct frame
+        {
+            set matched;        // of the production itself
+            set ancestors;      // union of matched of the production and all its ancestors
+            set prev_sibling;   // matched of the last child visited so far
+            set prev_siblings;  // union of matched of all children visited so far
+        };
+
+        // Cache the steps whose name matches, as names are interned, it is keyed by pointer.
+        std::unordered_map<const char*, set> name_cache;
+        auto                                 name_matches = [&](const char* name) {
+            auto iter = name_cache.find(name);
+            if (iter == name_cache.end())
+                iter = name_cache.emplace(name, _match_names(name)).first;
+            return iter->second;
+        };
+
+        auto result_bit = set(1) << (_steps.size() - 1);
+        auto visit      = [&](frame& parent, auto n) {
+            auto candidates = name_matches(n.kind().name());
+            auto matched    = set(0);
+            for (auto i = std::size_t(0); i != _steps.size(); ++i)
+            {
+                auto bit = set(1) << i;
+                if ((candidates & bit) == 0)
+                    continue;
+
+                if (i == 0)
+                {
+                    matched |= bit;
+                    continue;
+                }
+
+                auto prev = bit >> 1;
+                switch (_steps[i].combinator)
+                {
+                case _combinator::descendant:
+                    if (parent.ancestors & prev)
+                        matched |= bit;
+                    break;
+                case _combinator::child:
+                    if (parent.matched & prev)
+                        matched |= bit;
+                    break;
+                case _combinator::next_sibling:
+                    if (parent.prev_sibling & prev)
+                        matched |= bit;
+                    break;
+                case _combinator::subsequent_sibling:
+                    if (parent.prev_siblings & prev)
+                        matched |= bit;
+                    break;
+                }
+            }
+
+            parent.prev_sibling = matched;
+            parent.prev_siblings |= matched;
+
+            if (matched & result_bit)
+                fn(n);
+            return matched;
+        };
+
+        // The root is handled as child of an artificial frame.
+        std::vector<frame> stack;
+        stack.push_back({0, 0, 0, 0});
+        for (auto [event, n] : tree.traverse(node))
+        {
+            if (event == lexy::traverse_event::enter)
+            {
+                auto& parent  = stack.back();
+                auto  matched = visit(parent, n);
+                auto  cur     = frame{matched, parent.ancestors | matched, 0, 0};
+                stack.push_back(cur);
+            }
+            else if (event == lexy::traverse_event::exit)
+            {
+                stack.pop_back();
+            }
+            else
+            {
+                visit(stack.back(), n);
+            }
+        }
+    }
+    template <typename Reader, typename TokenKind, typename MemoryResource, typename Fn>
+    void for_each(const lexy::parse_tree<Reader, TokenKind, MemoryResource>& tree, Fn fn) const
+    {
+        if (!tree.empty())
+            for_each(tree, tree.root(), LEXY_MOV(fn));
+    }
+
+    /// Returns all nodes that match the query in document order.
+    template <typename Reader, typename TokenKind, typename MemoryResource>
+    auto find_all(const lexy::parse_tree<Reader, TokenKind, MemoryResource>& tree) const
+    {
+        std::vector<typename lexy::parse_tree<Reader, TokenKind, MemoryResource>::node> result;
+        for_each(tree, [&](auto node) { result.push_back(node); });
+        return result;
+    }
+
+private:
+    enum class _combinator
+    {
+        descendant,
+        child,
+        next_sibling,
+        subsequent_sibling,
+    };
+
+    struct _step
+    {
+        std::string name;
+        _combinator combinator;
+    };
+
+    void _invalidate() noexcept
+    {
+        _steps.clear();
+        _valid = false;
+    }
+
+    std::uint_least64_t _match_names(const char* name) const
+    {
+        auto length = std::strlen(name);
+
+        auto result = std::uint_least64_t(0);
+        for (auto i = std::size_t(0); i != _steps.size(); ++i)
+        {
+            auto& step = _steps[i].name;
+            if (step == "*" || step == name)
+                result |= std::uint_least64_t(1) << i;
+            else if (length > step.size() + 2
+                     && std::strcmp(name + length - step.size(), step.c_str()) == 0
+                     && std::strncmp(name + length - step.size() - 2, "::", 2) == 0)
+                result |= std::uint_least64_t(1) << i;
+        }
+        return result;
+    }
+
+    std::vector<_step> _steps;
+    bool               _valid;
+};
+} // namespace lexy_ext
+
+#endif // LEXY_EXT_PARSE_TREE_QUERY_HPP_INCLUDED
@@ -0,0 +1,222 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef LEXY_EXT_PREFETCHING_FILE_SOURCE_HPP_INCLUDED
+#define LEXY_EXT_PREFETCHING_FILE_SOURCE_HPP_INCLUDED
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <lexy/input/file.hpp>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lexy_ext
+{
+// A thread-safe memory resource that keeps a few freed blocks to reuse them for the next files.
+class _pf_buffer_pool
+{
+public:
+    explicit _pf_buffer_pool(std::size_t max_cached) noexcept : _max_cached(max_cached) {}
+
+    _pf_buffer_pool(const _pf_buffer_pool&) = delete;
+    _pf_buffer_pool& operator=(const _pf_buffer_pool&) = delete;
+
+    ~_pf_buffer_pool() noexcept
+    {
+        for (auto& block : _blocks)
+            ::operator delete(block.memory);
+    }
+
+    void* allocate(std::size_t bytes, std::size_t alignment)
+    {
+        LEXY_PRECONDITION(alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        (void)alignment;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            // Find the smallest block that is big enough.
+            auto best = _blocks.end();
+            for (auto iter = _blocks.begin(); iter != _blocks.end(); ++iter)
+                if (iter->size >= bytes && (best == _blocks.end() || iter->size < best->size))
+                    best = iter;
+
+            if (best != _blocks.end())
+            {
+                auto memory = best->memory;
+                _blocks.erase(best);
+                return memory;
+            }
+        }
+
+        return ::operator new(bytes);
+    }
+
+    void deallocate(void* ptr, std::size_t bytes, std::size_t) noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_blocks.size() < _max_cached)
+            {
+                // The block might be bigger, but we only know that it has at least that many bytes.
+                _blocks.push_back({ptr, bytes});
+                return;
+            }
+        }
+
+        ::operator delete(ptr);
+    }
+
+    friend bool operator==(const _pf_buffer_pool& lhs, const _pf_buffer_pool& rhs) noexcept
+    {
+        return &lhs == &rhs;
+    }
+
+private:
+    struct _block
+    {
+        void*       memory;
+        std::size_t size;
+    };
+
+    std::mutex          _mutex;
+    std::vector<_block> _blocks;
+    std::size_t         _max_cached;
+};
+
+/// Reads a sequence of files on a background thread, ahead of the one that is currently processed.
+///
+/// The files are returned in order. Up to `depth` files are read ahead, as long as their buffers
+/// take up less than `memory_cap` bytes in total; a single file that is bigger than that is read
+/// nonetheless. The buffers are allocated from a pool owned by the source, so the results must
+/// not outlive it.
+template <typename Encoding                = lexy::default_encoding,
+          lexy::encoding_endianness Endian = lexy::encoding_endianness::bom>
+class prefetching_file_source
+{
+public:
+    using result_type = lexy::read_file_result<Encoding, _pf_buffer_pool>;
+
+    explicit prefetching_file_source(std::vector<std::string> paths, std::size_t depth = 4,
+                                     std::size_t memory_cap = 64 * 1024 * 1024)
+    : _paths(LEXY_MOV(paths)), _depth(depth), _memory_cap(memory_cap), _pool(depth + 2),
+      _next(0), _queued_bytes(0), _stop(false)
+    {
+        LEXY_PRECONDITION(depth > 0);
+        _worker = std::thread([this] { _worker_main(); });
+    }
+
+    prefetching_file_source(const prefetching_file_source&) = delete;
+    prefetching_file_source& operator=(const prefetching_file_source&) = delete;
+
+    ~prefetching_file_source() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _space_available.notify_one();
+        _worker.join();
+    }
+
+    /// Whether all files have been returned.
+    bool empty() const noexcept
+    {
+        return _next == _paths.size();
+    }
+
+    /// The index of the file that is returned by the next call to `next()`.
+    std::size_t next_index() const noexcept
+    {
+        return _next;
+    }
+
+    const std::string& path(std::size_t idx) const noexcept
+    {
+        return _paths[idx];
+    }
+
+    /// Returns the next file, waiting until it has been read.
+    result_type next()
+    {
+        LEXY_PRECONDITION(!empty());
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _file_available.wait(lock, [&] { return !_queue.empty() || _exception; });
+        if (_queue.empty())
+            std::rethrow_exception(_exception);
+
+        auto result = LEXY_MOV(_queue.front().result);
+        _queued_bytes -= _queue.front().bytes;
+        _queue.pop_front();
+        ++_next;
+        lock.unlock();
+
+        _space_available.notify_one();
+        return result;
+    }
+
+private:
+    struct _entry
+    {
+        result_type result;
+        std::size_t bytes;
+    };
+
+    void _worker_main() noexcept
+    {
+        for (auto idx = std::size_t(0); idx != _paths.size(); ++idx)
+        {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _space_available.wait(lock, [&] {
+                    return _stop || (_queue.size() < _depth && _queued_bytes < _memory_cap);
+                });
+                if (_stop)
+                    return;
+            }
+
+            try
+            {
+                auto result = lexy::read_file<Encoding, Endian>(_paths[idx].c_str(), &_pool);
+                auto bytes  = result ? result.buffer().size() * sizeof(typename Encoding::char_type)
+                                     : 0;
+
+                std::lock_guard<std::mutex> lock(_mutex);
+                _queue.push_back({LEXY_MOV(result), bytes});
+                _queued_bytes += bytes;
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _exception = std::current_exception();
+            }
+            _file_available.notify_one();
+
+            if (_exception)
+                return;
+        }
+    }
+
+    std::vector<std::string> _paths;
+    std::size_t              _depth;
+    std::size_t              _memory_cap;
+    _pf_buffer_pool          _pool;
+    std::size_t              _next;
+
+    std::mutex              _mutex;
+    std::condition_variable _file_available, _space_available;
+    std::deque<_entry>      _queue;
+    std::size_t             _queued_bytes;
+    std::exception_ptr      _exception;
+    bool                    _stop;
+
+    std::thread _worker;
+};
+} // namespace lexy_ext
+
+#endif // LEXY_EXT_PREFETCHING_FILE_SOURCE_HPP_INCLUDED
@@ -0,0 +1,171 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef LEXY_EXT_THREAD_POOL_HPP_INCLUDED
+#define LEXY_EXT_THREAD_POOL_HPP_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <lexy/_detail/config.hpp>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lexy_ext
+{
+/// An executor that runs everything on the calling thread.
+struct sequential_executor
+{
+    template <typename Fn>
+    void parallel_for(std::size_t size, Fn&& fn)
+    {
+        for (auto i = std::size_t(0); i != size; ++i)
+            fn(i);
+    }
+};
+
+/// An executor that distributes work over a fixed set of threads.
+///
+/// `parallel_for()` must not be called concurrently or from within a task on the same pool.
+class thread_pool
+{
+public:
+    /// Creates a pool that uses the given number of threads in total, including the calling one.
+    explicit thread_pool(std::size_t thread_count = std::thread::hardware_concurrency())
+    : _job(nullptr), _generation(0), _busy(0), _stop(false)
+    {
+        // The calling thread participates as well.
+        for (auto i = std::size_t(1); i < thread_count; ++i)
+            _workers.emplace_back([this] { _worker_main(); });
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _job_available.notify_all();
+
+        for (auto& worker : _workers)
+            worker.join();
+    }
+
+    std::size_t thread_count() const noexcept
+    {
+        return _workers.size() + 1;
+    }
+
+    /// Invokes `fn(i)` for all `i` in `[0, size)` and waits until all of them are done.
+    /// Each index is claimed by the next idle thread, so unevenly sized tasks are balanced.
+    /// If a task throws, the first exception is rethrown after all tasks have finished.
+    template <typename Fn>
+    void parallel_for(std::size_t size, Fn&& fn)
+    {
+        if (size == 0)
+            return;
+
+        auto invoke = [](void* fn, std::size_t i) { (*static_cast<std::decay_t<Fn>*>(fn))(i); };
+        std::decay_t<Fn> fn_copy(LEXY_FWD(fn));
+        _job_t           job(invoke, &fn_copy, size);
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _job = &job;
+            ++_generation;
+        }
+        _job_available.notify_all();
+
+        _work(job);
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            // No new worker may pick up the job, and we wait for the remaining ones to finish.
+            _job = nullptr;
+            _job_done.wait(lock, [&] { return _busy == 0; });
+        }
+
+        if (job.exception)
+            std::rethrow_exception(job.exception);
+    }
+
+private:
+    struct _job_t
+    {
+        void (*invoke)(void*, std::size_t);
+        void*                    fn;
+        std::size_t              size;
+        std::atomic<std::size_t> next;
+
+        std::mutex         exception_mutex;
+        std::exception_ptr exception;
+
+        _job_t(void (*invoke)(void*, std::size_t), void* fn, std::size_t size)
+        : invoke(invoke), fn(fn), size(size), next(0)
+        {}
+    };
+
+    static void _work(_job_t& job) noexcept
+    {
+        for (auto i = job.next.fetch_add(1, std::memory_order_relaxed); i < job.size;
+             i      = job.next.fetch_add(1, std::memory_order_relaxed))
+        {
+            try
+            {
+                job.invoke(job.fn, i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(job.exception_mutex);
+                if (!job.exception)
+                    job.exception = std::current_exception();
+            }
+        }
+    }
+
+    void _worker_main() noexcept
+    {
+        auto generation = std::size_t(0);
+        while (true)
+        {
+            _job_t* job;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _job_available.wait(lock,
+                                    [&] { return _stop || (_job && _generation != generation); });
+                if (_stop)
+                    return;
+
+                generation = _generation;
+                job        = _job;
+                ++_busy;
+            }
+
+            _work(*job);
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                --_busy;
+            }
+            _job_done.notify_one();
+        }
+    }
+
+    std::vector<std::thread> _workers;
+
+    std::mutex              _mutex;
+    std::condition_variable _job_available, _job_done;
+    _job_t*                 _job;
+    std::size_t             _generation;
+    std::size_t             _busy;
+    bool                    _stop;
+};
+} // namespace lexy_ext
+
+#endif // LEXY_EXT_THREAD_POOL_HPP_INCLUDED
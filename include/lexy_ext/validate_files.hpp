@@ -0,0 +1,238 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef LEXY_EXT_VALIDATE_FILES_HPP_INCLUDED
+#define LEXY_EXT_VALIDATE_FILES_HPP_INCLUDED
+
+#include <functional>
+#include <iterator>
+#include <lexy/callback/adapter.hpp>
+#include <lexy/action/validate.hpp>
+#include <lexy/callback/noop.hpp>
+#include <lexy/input/file.hpp>
+#include <lexy_ext/thread_pool.hpp>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace lexy_ext
+{
+/// The result of validating a single file with `validate_files()`.
+class validate_file_result
+{
+public:
+    explicit validate_file_result(lexy::file_error ec) noexcept : _ec(ec), _error_count(0) {}
+    explicit validate_file_result(std::size_t error_count) noexcept
+    : _ec(lexy::file_error::_success), _error_count(error_count)
+    {}
+
+    /// Whether the file could be read and validated without errors.
+    explicit operator bool() const noexcept
+    {
+        return was_read() && _error_count == 0;
+    }
+
+    bool was_read() const noexcept
+    {
+        return _ec == lexy::file_error::_success;
+    }
+
+    lexy::file_error read_error() const noexcept
+    {
+        LEXY_PRECONDITION(!was_read());
+        return _ec;
+    }
+
+    /// The number of errors raised while validating the file.
+    std::size_t error_count() const noexcept
+    {
+        return _error_count;
+    }
+
+private:
+    lexy::file_error _ec;
+    std::size_t      _error_count;
+};
+
+// A memory resource that keeps the biggest deallocated block to reuse it for the next file.
+class _vf_buffer_resource
+{
+public:
+    _vf_buffer_resource() noexcept : _block(nullptr), _size(0), _is_lent(false) {}
+
+    _vf_buffer_resource(const _vf_buffer_resource&) = delete;
+    _vf_buffer_resource& operator=(const _vf_buffer_resource&) = delete;
+
+    ~_vf_buffer_resource() noexcept
+    {
+        if (_block != nullptr)
+            ::operator delete(_block);
+    }
+
+    void* allocate(std::size_t bytes, std::size_t alignment)
+    {
+        LEXY_PRECONDITION(alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        (void)alignment;
+
+        if (_block != nullptr && !_is_lent && bytes <= _size)
+        {
+            // `_size` remains the size of the entire block, not just the part that is used.
+            _is_lent = true;
+            return _block;
+        }
+        else
+        {
+            return ::operator new(bytes);
+        }
+    }
+
+    void deallocate(void* ptr, std::size_t bytes, std::size_t) noexcept
+    {
+        if (ptr == _block)
+        {
+            // We get our block back.
+            _is_lent = false;
+        }
+        else if (_block == nullptr || (!_is_lent && bytes > _size))
+        {
+            // We keep the bigger one of the two blocks.
+            if (_block != nullptr)
+                ::operator delete(_block);
+            _block = ptr;
+            _size  = bytes;
+        }
+        else
+        {
+            ::operator delete(ptr);
+        }
+    }
+
+
+    friend bool operator==(const _vf_buffer_resource& lhs, const _vf_buffer_resource& rhs) noexcept
+    {
+        return &lhs == &rhs;
+    }
+
+private:
+    void*       _block;
+    std::size_t _size;
+    bool        _is_lent;
+};
+
+// Hands out one buffer resource per concurrently running task.
+class _vf_buffer_resource_pool
+{
+public:
+    std::unique_ptr<_vf_buffer_resource> acquire()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_free.empty())
+            return std::make_unique<_vf_buffer_resource>();
+
+        auto result = LEXY_MOV(_free.back());
+        _free.pop_back();
+        return result;
+    }
+
+    void release(std::unique_ptr<_vf_buffer_resource> resource)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _free.push_back(LEXY_MOV(resource));
+    }
+
+private:
+    std::mutex                                        _mutex;
+    std::vector<std::unique_ptr<_vf_buffer_resource>> _free;
+};
+
+inline const char* _vf_c_str(const char* path) noexcept
+{
+    return path;
+}
+template <typename String>
+auto _vf_c_str(const String& path) noexcept -> decltype(path.c_str())
+{
+    return path.c_str();
+}
+
+/// Reads and validates each file of `paths` using `executor.parallel_for()`.
+///
+/// The file buffers are allocated from a memory resource per task, so files are not copied into
+/// freshly allocated memory each time.
+/// Returns the result of each file in the order of `paths`.
+///
+/// The error callback is invoked for each error, and must return `void`.
+/// The errors of a file are recorded while it is validated, and delivered after that while holding
+/// a lock, so errors of different files do not interleave.
+template <typename Production, typename Encoding = lexy::default_encoding,
+          lexy::encoding_endianness Endian = lexy::encoding_endianness::bom, typename Paths,
+          typename Executor, typename ErrorCallback,
+          typename = std::enable_if_t<!std::is_integral_v<Executor>>>
+auto validate_files(const Paths& paths, Executor& executor, const ErrorCallback& callback)
+    -> std::vector<validate_file_result>
+{
+    static_assert(std::is_same_v<ErrorCallback, lexy::_noop>
+                      || (!lexy::is_sink<ErrorCallback>
+                          && std::is_void_v<typename ErrorCallback::return_type>),
+                  "validate_files() requires a callback that is invoked for each error and "
+                  "returns void");
+
+    auto begin = std::begin(paths);
+    auto size  = std::size_t(std::distance(begin, std::end(paths)));
+
+    std::vector<validate_file_result> result(size, validate_file_result(std::size_t(0)));
+    _vf_buffer_resource_pool          resources;
+    std::mutex                        report_mutex;
+    executor.parallel_for(size, [&](std::size_t idx) {
+        auto path     = _vf_c_str(*std::next(begin, std::ptrdiff_t(idx)));
+        auto resource = resources.acquire();
+
+        {
+            auto file = lexy::read_file<Encoding, Endian>(path, resource.get());
+            if (!file)
+            {
+                result[idx] = validate_file_result(file.error());
+            }
+            else
+            {
+                // We record the errors, which refer to the buffer, and only report them once
+                // we're done; only that needs to be serialized.
+                std::vector<std::function<void()>> errors;
+                auto record = lexy::callback([&](const auto& context, const auto& error) {
+                    errors.emplace_back([&callback, context, error] { callback(context, error); });
+                });
+
+                auto& input      = file.buffer();
+                auto error_count = lexy::validate<Production>(input, record).error_count();
+                if (error_count > 0)
+                {
+                    std::lock_guard<std::mutex> lock(report_mutex);
+                    for (auto& report : errors)
+                        report();
+                }
+
+                result[idx] = validate_file_result(error_count);
+            }
+        }
+
+        resources.release(LEXY_MOV(resource));
+    });
+    return result;
+}
+
+/// Same as above, but uses a new `thread_pool` with the specified number of threads.
+template <typename Production, typename Encoding = lexy::default_encoding,
+          lexy::encoding_endianness Endian = lexy::encoding_endianness::bom, typename Paths,
+          typename ErrorCallback>
+auto validate_files(const Paths& paths, std::size_t thread_count, const ErrorCallback& callback)
+    -> std::vector<validate_file_result>
+{
+    thread_pool pool(thread_count);
+    return validate_files<Production, Encoding, Endian>(paths, pool, callback);
+}
+} // namespace lexy_ext
+
+#endif // LEXY_EXT_VALIDATE_FILES_HPP_INCLUDED
@@ -5,15 +5,111 @@
 #include <lexy/input/file.hpp>
 
 #include <cerrno>
+#include <cstdint>
 #include <cstdio>
 #include <lexy/_detail/buffer_builder.hpp>
+#include <new>
+
+namespace
+{
+// Forwards the result of read_file() to a read_files() callback.
+struct read_files_user_data
+{
+    lexy::_detail::read_files_callback cb;
+    void*                              user_data;
+    std::size_t                        index;
+
+    static void callback(void* _self, const char* memory, std::size_t size)
+    {
+        auto self = static_cast<read_files_user_data*>(_self);
+        self->cb(self->user_data, self->index, lexy::file_error::_success, memory, size);
+    }
+};
+
+// Reads one file after the other.
+void read_files_sequential(const char* const* paths, std::size_t count,
+                           lexy::_detail::read_files_callback cb, void* user_data)
+{
+    for (auto i = std::size_t(0); i != count; ++i)
+    {
+        read_files_user_data data{cb, user_data, i};
+        auto ec = lexy::_detail::read_file(paths[i], &read_files_user_data::callback, &data);
+        if (ec != lexy::file_error::_success)
+            cb(user_data, i, ec, nullptr, 0);
+    }
+}
+
+// Reads stdin using the C I/O routines, which works for everything.
+lexy::file_error read_stdin_buffered(lexy::_detail::file_callback cb, void* user_data)
+{
+    // We can't use ftell() to get file size
+    // So instead use a conservative loop.
+    lexy::_detail::buffer_builder<char> builder;
+    while (true)
+    {
+        const auto buffer_size = builder.write_size();
+        LEXY_ASSERT(buffer_size > 0, "buffer empty?!");
+
+        // Read into the entire write area of the buffer from stdin,
+        // commiting what we've just read.
+        const auto read = std::fread(builder.write_data(), sizeof(char), buffer_size, stdin);
+        builder.commit(read);
+
+        // Check whether we have exhausted the file.
+        if (read < buffer_size)
+        {
+            if (std::ferror(stdin) != 0)
+                // We have a read error.
+                return lexy::file_error::os_error;
+
+            // We should have reached the end.
+            LEXY_ASSERT(std::feof(stdin), "why did fread() not read enough?");
+            break;
+        }
+
+        // We've filled the entire buffer and need more space.
+        // This grow might be unnecessary if we're just so happen to reach EOF with the next
+        // input, but checking this requires reading more input.
+        builder.grow();
+    }
+
+    // Pass final buffer to callback.
+    cb(user_data, builder.read_data(), builder.read_size());
+    return lexy::file_error::_success;
+}
+} // namespace
 
 #if defined(__unix__) || defined(__APPLE__)
 
 #    include <fcntl.h>
 #    include <sys/mman.h>
+#    include <sys/stat.h>
 #    include <unistd.h>
 
+#    if defined(__linux__) && defined(__has_include) && !defined(LEXY_DISABLE_IO_URING)
+#        if __has_include(<linux/io_uring.h>) && __has_include(<linux/version.h>)
+#            include <linux/io_uring.h>
+#            include <linux/version.h>
+// We need the headers of Linux 5.6, which added openat(), statx() and the probe.
+// They're enumerators, not macros, so we can't check for them directly.
+#            if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 6, 0)
+#                define LEXY_HAS_IO_URING 1
+#            endif
+#        endif
+#    endif
+#    ifndef LEXY_HAS_IO_URING
+#        define LEXY_HAS_IO_URING 0
+#    endif
+
+#    if LEXY_HAS_IO_URING
+#        include <algorithm>
+#        include <cstring>
+#        include <initializer_list>
+#        include <memory>
+#        include <sys/syscall.h>
+#        include <vector>
+#    endif
+
 namespace
 {
 class raii_fd
@@ -39,9 +135,9 @@ private:
     int _file;
 };
 
-lexy::file_error get_file_error() noexcept
+lexy::file_error get_file_error(int error = errno) noexcept
 {
-    switch (errno)
+    switch (error)
     {
     case ENOENT:
     case ENOTDIR:
@@ -59,6 +155,29 @@ lexy::file_error get_file_error() noexcept
 
 constexpr std::size_t small_file_size  = 4 * 1024;
 constexpr std::size_t medium_file_size = 32 * 1024;
+#    if defined(MAP_ANONYMOUS) && defined(MADV_HUGEPAGE)
+constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+#    endif
+
+// Maps the file into memory, to be read once from beginning to end.
+// Returns nullptr on failure.
+const char* map_file(int fd, std::size_t size) noexcept
+{
+    auto flags = MAP_PRIVATE;
+#    if defined(MAP_POPULATE) && defined(LEXY_ENABLE_MAP_POPULATE)
+    // Read the entire file now instead of page faulting on each page.
+    flags |= MAP_POPULATE;
+#    endif
+
+    auto memory = ::mmap(nullptr, size, PROT_READ, flags, fd, 0);
+    if (memory == MAP_FAILED) // NOLINT: int-to-ptr conversion happens in header
+        return nullptr;
+
+    // The hints are just an optimization, so we don't care whether they work.
+    ::posix_madvise(memory, size, POSIX_MADV_SEQUENTIAL);
+    ::posix_madvise(memory, size, POSIX_MADV_WILLNEED);
+    return static_cast<const char*>(memory);
+}
 } // namespace
 
 lexy::file_error lexy::_detail::read_file(const char* path, file_callback cb, void* user_data)
@@ -96,18 +215,550 @@ lexy::file_error lexy::_detail::read_file(const char* path, file_callback cb, vo
     }
     else
     {
-        auto memory = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
-        if (memory == MAP_FAILED) // NOLINT: int-to-ptr conversion happens in header
+        auto memory = map_file(fd, size);
+        if (memory == nullptr)
             return lexy::file_error::os_error;
 
-        cb(user_data, reinterpret_cast<const char*>(memory), size);
+        cb(user_data, memory, size);
 
-        ::munmap(memory, size);
+        ::munmap(const_cast<char*>(memory), size);
     }
 
     return lexy::file_error::_success;
 }
 
+#    if LEXY_HAS_IO_URING
+namespace
+{
+// A memory mapping of one of the rings, which is unmapped in the destructor.
+class raii_ring_mapping
+{
+public:
+    raii_ring_mapping() noexcept = default;
+
+    raii_ring_mapping(const raii_ring_mapping&) = delete;
+    raii_ring_mapping& operator=(const raii_ring_mapping&) = delete;
+
+    ~raii_ring_mapping() noexcept
+    {
+        if (_memory != nullptr)
+            ::munmap(_memory, _size);
+    }
+
+    // Returns false if the mapping failed.
+    bool map(int fd, std::size_t size, ::off_t offset) noexcept
+    {
+        LEXY_PRECONDITION(_memory == nullptr);
+        auto memory
+            = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+        if (memory == MAP_FAILED) // NOLINT
+            return false;
+
+        _memory = memory;
+        _size   = size;
+        return true;
+    }
+
+    char* get() const noexcept
+    {
+        return static_cast<char*>(_memory);
+    }
+
+private:
+    void*       _memory = nullptr;
+    std::size_t _size   = 0;
+};
+
+// A minimal io_uring using the system calls directly, so we don't depend on liburing.
+//
+// Closing the ring does not wait for pending requests: the kernel tears it down asynchronously,
+// so the memory they refer to must outlive them.
+class io_uring
+{
+public:
+    explicit io_uring(unsigned entries) noexcept : io_uring(entries, io_uring_params{}) {}
+
+    io_uring(const io_uring&) = delete;
+    io_uring& operator=(const io_uring&) = delete;
+
+    explicit operator bool() const noexcept
+    {
+        return _is_mapped;
+    }
+
+    // Whether the kernel supports all of the operations.
+    bool supports(std::initializer_list<int> ops) const noexcept
+    {
+        constexpr auto max_ops = 256u;
+        alignas(io_uring_probe) unsigned char
+            storage[sizeof(io_uring_probe) + max_ops * sizeof(io_uring_probe_op)] = {};
+        auto probe = reinterpret_cast<io_uring_probe*>(storage);
+        if (::syscall(__NR_io_uring_register, int(_fd), IORING_REGISTER_PROBE, probe, max_ops) < 0)
+            return false;
+
+        for (auto op : ops)
+            if (op > probe->last_op || (probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0)
+                return false;
+        return true;
+    }
+
+    // Returns a cleared submission queue entry, or nullptr if the queue is full.
+    io_uring_sqe* get_sqe(std::uint64_t user_data) noexcept
+    {
+        auto head = __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+        if (_sq_local - head == _sq_entries)
+            return nullptr;
+
+        auto idx = _sq_local & *_sq_mask;
+        ++_sq_local;
+
+        auto sqe = &_sqes[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->user_data = user_data;
+        _sq_array[idx] = idx;
+        return sqe;
+    }
+
+    // Submits all new entries and waits until at least one request has completed.
+    bool submit_and_wait() noexcept
+    {
+        __atomic_store_n(_sq_tail, _sq_local, __ATOMIC_RELEASE);
+        auto to_submit = _sq_local - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+
+        long result;
+        do
+        {
+            result = ::syscall(__NR_io_uring_enter, int(_fd), to_submit, 1, IORING_ENTER_GETEVENTS,
+                               nullptr, 0);
+        } while (result < 0 && errno == EINTR);
+        return result >= 0;
+    }
+
+    // Invokes `fn(user_data, result)` for every completed request.
+    // Each completion is consumed before `fn` is invoked, so it is not seen again if `fn` throws.
+    template <typename Fn>
+    void for_each_completion(Fn fn)
+    {
+        auto head = *_cq_head;
+        auto tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+        while (head != tail)
+        {
+            auto cqe = _cqes[head & *_cq_mask];
+            ++head;
+            __atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+
+            fn(cqe.user_data, cqe.res);
+        }
+    }
+
+private:
+    // If any step of the setup fails, the guards close and unmap everything created so far.
+    explicit io_uring(unsigned entries, io_uring_params&& params) noexcept
+    : _fd(static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params)))
+    {
+        if (_fd < 0)
+            return;
+
+        auto sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        auto cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        auto single  = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single)
+            sq_size = cq_size = std::max(sq_size, cq_size);
+
+        if (!_sq_ring.map(_fd, sq_size, IORING_OFF_SQ_RING))
+            return;
+        if (!single && !_cq_ring.map(_fd, cq_size, IORING_OFF_CQ_RING))
+            return;
+        if (!_sqe_array.map(_fd, params.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES))
+            return;
+
+        _sqes       = reinterpret_cast<io_uring_sqe*>(_sqe_array.get());
+        _sq_entries = params.sq_entries;
+
+        auto sq    = _sq_ring.get();
+        _sq_head   = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        _sq_tail   = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        _sq_mask   = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        _sq_array  = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        _sq_local  = *_sq_tail;
+        auto cq    = single ? _sq_ring.get() : _cq_ring.get();
+        _cq_head   = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        _cq_tail   = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        _cq_mask   = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        _cqes      = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        _is_mapped = true;
+    }
+
+    // The mappings are declared after the fd, so they're unmapped before it is closed.
+    raii_fd           _fd;
+    raii_ring_mapping _sq_ring, _cq_ring, _sqe_array;
+    bool              _is_mapped = false;
+
+    io_uring_sqe* _sqes = nullptr;
+
+    unsigned  _sq_entries = 0;
+    unsigned  _sq_local   = 0;
+    unsigned* _sq_head    = nullptr;
+    unsigned* _sq_tail    = nullptr;
+    unsigned* _sq_mask    = nullptr;
+    unsigned* _sq_array   = nullptr;
+
+    unsigned*     _cq_head = nullptr;
+    unsigned*     _cq_tail = nullptr;
+    unsigned*     _cq_mask = nullptr;
+    io_uring_cqe* _cqes    = nullptr;
+};
+
+// A file whose requests are in flight.
+struct io_uring_file
+{
+    std::size_t             index   = 0;
+    int                     fd      = -1;
+    int                     error   = 0;
+    int                     pending = 0;
+    struct statx            stat    = {};
+    std::unique_ptr<char[]> buffer;
+    std::size_t             size = 0;
+    std::size_t             read = 0;
+
+    io_uring_file() = default;
+    io_uring_file(const io_uring_file&) = delete;
+    io_uring_file& operator=(const io_uring_file&) = delete;
+
+    ~io_uring_file() noexcept
+    {
+        if (fd >= 0)
+            ::close(fd);
+    }
+};
+
+// Returns false if io_uring cannot be used, without having invoked the callback.
+bool read_files_io_uring(const char* const* paths, std::size_t count,
+                         lexy::_detail::read_files_callback cb, void* user_data)
+{
+    // For each file, we submit an openat() and a statx(), followed by a read() once both are done.
+    constexpr auto queue_depth = 64u;
+    constexpr auto max_files   = queue_depth / 2;
+    enum operation : std::uint64_t
+    {
+        op_open,
+        op_stat,
+        op_read,
+        op_cancel,
+        op_count,
+    };
+
+    std::unique_ptr<io_uring_file[]> files(new io_uring_file[max_files]);
+
+    io_uring ring(queue_depth);
+    if (!ring || !ring.supports({IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ}))
+        return false;
+
+    // The kernel writes into the files while their requests are in flight, so before returning or
+    // propagating an exception, we cancel the requests and wait until all of them have completed.
+    // If waiting fails, we leak the files instead.
+    auto drain = [&]() noexcept {
+        for (auto slot = std::size_t(0); slot != max_files; ++slot)
+        {
+            if (files[slot].pending == 0)
+                continue;
+
+            // Once the buffer is allocated, only the read is in flight.
+            for (auto op : {op_open, op_stat, op_read})
+            {
+                if ((op == op_read) != (files[slot].buffer != nullptr))
+                    continue;
+
+                // Cancelling is just faster than waiting, so it doesn't matter if the queue is full.
+                if (auto sqe = ring.get_sqe(slot * op_count + op_cancel))
+                {
+                    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+                    sqe->addr   = slot * op_count + op;
+                }
+            }
+        }
+
+        auto is_pending = [&] {
+            return std::any_of(files.get(), files.get() + max_files,
+                               [](const io_uring_file& file) { return file.pending != 0; });
+        };
+        while (is_pending())
+        {
+            if (!ring.submit_and_wait())
+            {
+                files.release();
+                return;
+            }
+
+            ring.for_each_completion([&](std::uint64_t data, int result) {
+                if (data % op_count == op_cancel)
+                    return;
+
+                auto& file = files[data / op_count];
+                --file.pending;
+                if (data % op_count == op_open && result >= 0)
+                    // Closed by the destructor.
+                    file.fd = result;
+            });
+        }
+    };
+    struct drain_guard
+    {
+        decltype(drain)& fn;
+
+        ~drain_guard() noexcept
+        {
+            fn();
+        }
+    } guard{drain};
+
+    std::vector<std::size_t> free_files;
+    for (auto i = std::size_t(0); i != max_files; ++i)
+        free_files.push_back(max_files - i - 1);
+
+    auto submit_read = [&](std::size_t slot) {
+        auto& file = files[slot];
+        auto  sqe  = ring.get_sqe(slot * op_count + op_read);
+        LEXY_ASSERT(sqe != nullptr, "submission queue is bigger than the number of requests");
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd     = file.fd;
+        sqe->addr   = reinterpret_cast<std::uintptr_t>(file.buffer.get() + file.read);
+        sqe->len    = static_cast<unsigned>(std::min<std::size_t>(file.size - file.read, 1u << 30));
+        sqe->off    = file.read;
+        ++file.pending;
+    };
+    auto finish = [&](std::size_t slot, lexy::file_error ec) {
+        auto& file = files[slot];
+        if (file.fd >= 0)
+        {
+            ::close(file.fd);
+            file.fd = -1;
+        }
+
+        if (ec == lexy::file_error::_success)
+            // Empty files don't have a buffer, but the memory must not be null.
+            cb(user_data, file.index, ec, file.buffer ? file.buffer.get() : "", file.size);
+        else
+            cb(user_data, file.index, ec, nullptr, 0);
+
+        file.buffer.reset();
+        free_files.push_back(slot);
+    };
+    auto opened = [&](std::size_t slot) {
+        auto& file = files[slot];
+        if (file.error != 0)
+        {
+            finish(slot, get_file_error(file.error));
+            return;
+        }
+
+        file.size = static_cast<std::size_t>(file.stat.stx_size);
+        if (file.size > medium_file_size)
+        {
+            // Big files are mapped into memory as usual.
+            ::close(file.fd);
+            file.fd = -1;
+
+            read_files_user_data data{cb, user_data, file.index};
+            auto ec = lexy::_detail::read_file(paths[file.index], &read_files_user_data::callback,
+                                               &data);
+            if (ec != lexy::file_error::_success)
+                cb(user_data, file.index, ec, nullptr, 0);
+            free_files.push_back(slot);
+        }
+        else if (file.size == 0)
+        {
+            finish(slot, lexy::file_error::_success);
+        }
+        else
+        {
+            file.buffer.reset(new char[file.size]); // Don't initialize.
+            submit_read(slot);
+        }
+    };
+
+    auto next_path = std::size_t(0);
+    while (next_path != count || free_files.size() != max_files)
+    {
+        while (next_path != count && !free_files.empty())
+        {
+            auto  slot = free_files.back();
+            auto& file = files[slot];
+            free_files.pop_back();
+
+            file.index   = next_path;
+            file.error   = 0;
+            file.pending = 2;
+            file.read    = 0;
+
+            auto open        = ring.get_sqe(slot * op_count + op_open);
+            open->opcode     = IORING_OP_OPENAT;
+            open->fd         = AT_FDCWD;
+            open->addr       = reinterpret_cast<std::uintptr_t>(paths[next_path]);
+            open->open_flags = O_RDONLY | O_CLOEXEC;
+
+            auto stat         = ring.get_sqe(slot * op_count + op_stat);
+            stat->opcode      = IORING_OP_STATX;
+            stat->fd          = AT_FDCWD;
+            stat->addr        = reinterpret_cast<std::uintptr_t>(paths[next_path]);
+            stat->len         = STATX_SIZE;
+            stat->off         = reinterpret_cast<std::uintptr_t>(&file.stat);
+            stat->statx_flags = 0;
+
+            ++next_path;
+        }
+
+        if (!ring.submit_and_wait())
+        {
+            // Something went horribly wrong, so we give up on the files that haven't been read.
+            // The guard takes care of the requests that are still in flight.
+            for (auto slot = std::size_t(0); slot != max_files; ++slot)
+                if (std::find(free_files.begin(), free_files.end(), slot) == free_files.end())
+                    cb(user_data, files[slot].index, lexy::file_error::os_error, nullptr, 0);
+            for (; next_path != count; ++next_path)
+                cb(user_data, next_path, lexy::file_error::os_error, nullptr, 0);
+            return true;
+        }
+
+        ring.for_each_completion([&](std::uint64_t data, int result) {
+            auto  slot = std::size_t(data / op_count);
+            auto& file = files[slot];
+            --file.pending;
+
+            switch (data % op_count)
+            {
+            case op_open:
+            case op_stat:
+                if (result < 0 && file.error == 0)
+                    file.error = -result;
+                else if (data % op_count == op_open && result >= 0)
+                    file.fd = result;
+
+                if (file.pending == 0)
+                    opened(slot);
+                break;
+
+            case op_read:
+                if (result == -EAGAIN || result == -EINTR)
+                {
+                    // Nothing has been read, so we try again.
+                    submit_read(slot);
+                    break;
+                }
+                else if (result <= 0)
+                {
+                    // Either reading failed, or the file was truncated in the mean time.
+                    finish(slot, lexy::file_error::os_error);
+                    break;
+                }
+
+                file.read += static_cast<std::size_t>(result);
+                if (file.read < file.size)
+                    submit_read(slot);
+                else
+                    finish(slot, lexy::file_error::_success);
+                break;
+            }
+        });
+    }
+
+    return true;
+}
+} // namespace
+#    endif
+
+void lexy::_detail::read_files(const char* const* paths, std::size_t count, read_files_callback cb,
+                               void* user_data)
+{
+#    if LEXY_HAS_IO_URING
+    if (read_files_io_uring(paths, count, cb, user_data))
+        return;
+#    endif
+
+    read_files_sequential(paths, count, cb, user_data);
+}
+
+lexy::file_error lexy::_detail::read_stdin(file_callback cb, void* user_data)
+{
+    // If stdin is redirected from a regular file, we can map it into memory like read_file().
+    // We use ftell() to determine the position, as the C I/O routines might have buffered input.
+    struct ::stat info;
+    auto          offset = std::ftell(stdin);
+    if (offset >= 0 && ::fstat(STDIN_FILENO, &info) == 0 && S_ISREG(info.st_mode)
+        && info.st_size - offset > static_cast<::off_t>(medium_file_size))
+    {
+        auto size   = static_cast<std::size_t>(info.st_size);
+        auto memory = map_file(STDIN_FILENO, size);
+        if (memory != nullptr)
+        {
+            // We've consumed everything.
+            std::fseek(stdin, 0, SEEK_END);
+
+            auto begin = static_cast<std::size_t>(offset);
+            cb(user_data, memory + begin, size - begin);
+
+            ::munmap(const_cast<char*>(memory), size);
+            return lexy::file_error::_success;
+        }
+    }
+
+    // Otherwise, it's a pipe, a terminal, or small, and we need to read it.
+    return read_stdin_buffered(cb, user_data);
+}
+
+void* lexy::_detail::allocate_huge_pages(std::size_t bytes)
+{
+#    if defined(MAP_ANONYMOUS) && defined(MADV_HUGEPAGE)
+    if (auto size = huge_page_mapping_size(bytes); size != 0)
+    {
+        // Huge pages need to be aligned, so we allocate an additional one to align the memory.
+        auto memory = ::mmap(nullptr, size + huge_page_size, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) // NOLINT: int-to-ptr conversion happens in header
+            throw std::bad_alloc();
+
+        // Unmap the parts before and after the aligned memory.
+        auto begin        = static_cast<char*>(memory);
+        auto misalignment = reinterpret_cast<std::uintptr_t>(begin) % huge_page_size;
+        auto aligned      = misalignment == 0 ? begin : begin + (huge_page_size - misalignment);
+        if (aligned != begin)
+            ::munmap(begin, std::size_t(aligned - begin));
+        if (auto end = begin + size + huge_page_size; aligned + size != end)
+            ::munmap(aligned + size, std::size_t(end - (aligned + size)));
+
+        // The hint is just an optimization, so we don't care whether it works.
+        ::madvise(aligned, size, MADV_HUGEPAGE);
+        return aligned;
+    }
+#    endif
+
+    return ::operator new(bytes);
+}
+
+void lexy::_detail::deallocate_huge_pages(void* memory, std::size_t bytes) noexcept
+{
+#    if defined(MAP_ANONYMOUS) && defined(MADV_HUGEPAGE)
+    if (auto size = huge_page_mapping_size(bytes); size != 0)
+    {
+        ::munmap(memory, size);
+        return;
+    }
+#    endif
+
+    ::operator delete(memory);
+}
+
+std::size_t lexy::_detail::huge_page_mapping_size(std::size_t bytes) noexcept
+{
+#    if defined(MAP_ANONYMOUS) && defined(MADV_HUGEPAGE)
+    if (bytes >= huge_page_size)
+        return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+#    endif
+
+    (void)bytes;
+    return 0;
+}
+
 #else // portable read_file() using C I/O
 
 namespace
@@ -184,45 +835,31 @@ lexy::file_error lexy::_detail::read_file(const char* path, file_callback cb, vo
     return file_error::_success;
 }
 
-#endif
+void lexy::_detail::read_files(const char* const* paths, std::size_t count, read_files_callback cb,
+                               void* user_data)
+{
+    read_files_sequential(paths, count, cb, user_data);
+}
 
 // When reading from stdin, performance doesn't really matter.
-// As such, we use the simple portable way of the C I/O routines.
 lexy::file_error lexy::_detail::read_stdin(file_callback cb, void* user_data)
 {
-    // We can't use ftell() to get file size
-    // So instead use a conservative loop.
-    lexy::_detail::buffer_builder<char> builder;
-    while (true)
-    {
-        const auto buffer_size = builder.write_size();
-        LEXY_ASSERT(buffer_size > 0, "buffer empty?!");
-
-        // Read into the entire write area of the buffer from stdin,
-        // commiting what we've just read.
-        const auto read = std::fread(builder.write_data(), sizeof(char), buffer_size, stdin);
-        builder.commit(read);
-
-        // Check whether we have exhausted the file.
-        if (read < buffer_size)
-        {
-            if (std::ferror(stdin) != 0)
-                // We have a read error.
-                return lexy::file_error::os_error;
+    return read_stdin_buffered(cb, user_data);
+}
 
-            // We should have reached the end.
-            LEXY_ASSERT(std::feof(stdin), "why did fread() not read enough?");
-            break;
-        }
+void* lexy::_detail::allocate_huge_pages(std::size_t bytes)
+{
+    return ::operator new(bytes);
+}
 
-        // We've filled the entire buffer and need more space.
-        // This grow might be unnecessary if we're just so happen to reach EOF with the next
-        // input, but checking this requires reading more input.
-        builder.grow();
-    }
+void lexy::_detail::deallocate_huge_pages(void* memory, std::size_t) noexcept
+{
+    ::operator delete(memory);
+}
 
-    // Pass final buffer to callback.
-    cb(user_data, builder.read_data(), builder.read_size());
-    return file_error::_success;
+std::size_t lexy::_detail::huge_page_mapping_size(std::size_t) noexcept
+{
+    return 0;
 }
 
+#endif
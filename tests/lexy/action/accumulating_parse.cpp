@@ -0,0 +1,117 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <lexy/action/accumulating_parse.hpp>
+
+#include <doctest/doctest.h>
+#include <lexy/callback.hpp>
+#include <lexy/dsl/ascii.hpp>
+#include <lexy/dsl/identifier.hpp>
+#include <lexy/dsl/literal.hpp>
+#include <lexy/dsl/sequence.hpp>
+#include <lexy/input/string_input.hpp>
+#include <string>
+
+namespace
+{
+namespace dsl = lexy::dsl;
+
+// GET name\n
+struct request
+{
+    static constexpr auto rule
+        = LEXY_LIT("GET ") + dsl::identifier(dsl::ascii::alpha) + dsl::lit_c<'\n'>;
+    static constexpr auto value
+        = lexy::callback<std::size_t>([](auto lexeme) { return lexeme.size(); });
+};
+
+template <typename Result>
+void check_same(const Result& actual, const Result& expected)
+{
+    CHECK(actual.is_success() == expected.is_success());
+    CHECK(actual.is_fatal_error() == expected.is_fatal_error());
+    CHECK(actual.error_count() == expected.error_count());
+    CHECK(actual.has_value() == expected.has_value());
+    if (actual.has_value() && expected.has_value())
+        CHECK(actual.value() == expected.value());
+}
+} // namespace
+
+TEST_CASE("accumulating_parser")
+{
+    auto one_shot = [](const char* str) {
+        return lexy::parse<request>(lexy::zstring_input(str), lexy::count);
+    };
+
+    lexy::accumulating_parser<request> parser;
+    CHECK(parser.status() == lexy::accumulate_status::need_more);
+
+    SUBCASE("pieces")
+    {
+        CHECK(parser.feed("GE", 2) == lexy::accumulate_status::need_more);
+        CHECK(parser.feed("T ab", 4) == lexy::accumulate_status::need_more);
+        CHECK(parser.feed("c", 1) == lexy::accumulate_status::need_more);
+        CHECK(parser.feed("", 0) == lexy::accumulate_status::need_more);
+        // Not enough new data since the check of "GET ab" to check again.
+        CHECK(parser.feed("\nGET", 4) == lexy::accumulate_status::need_more);
+        CHECK(parser.check() == lexy::accumulate_status::complete);
+        CHECK(parser.status() == lexy::accumulate_status::complete);
+        CHECK(parser.input().size() == 11);
+
+        check_same(parser.finish(lexy::count), one_shot("GET abc\nGET"));
+        CHECK(parser.finish(lexy::count).value() == 3);
+    }
+    SUBCASE("every split")
+    {
+        const char* inputs[]
+            = {"GET abc\n", "GET abc\nrest", "GET \n", "GETabc\n", "POST a\n", "GET ab"};
+        for (auto str : inputs)
+        {
+            auto size = std::strlen(str);
+            for (auto split = std::size_t(0); split <= size; ++split)
+            {
+                parser.reset();
+                parser.feed(str, split);
+                parser.feed(str + split, size - split);
+                check_same(parser.finish(lexy::count), one_shot(str));
+            }
+        }
+    }
+    SUBCASE("early failure")
+    {
+        CHECK(parser.feed("GET 1", 5) == lexy::accumulate_status::failed);
+        // Once failed, more data doesn't change anything.
+        CHECK(parser.feed("abc\n", 4) == lexy::accumulate_status::failed);
+        CHECK(parser.finish(lexy::count).is_fatal_error());
+
+        parser.reset();
+        CHECK(parser.status() == lexy::accumulate_status::need_more);
+        CHECK(parser.input().size() == 0);
+        CHECK(parser.feed("GET a\n", 6) == lexy::accumulate_status::complete);
+    }
+    SUBCASE("doubling")
+    {
+        CHECK(parser.feed("GET a", 5) == lexy::accumulate_status::need_more);
+        CHECK(parser.feed("b\n", 2) == lexy::accumulate_status::need_more);
+        // Now there are 10 bytes, twice as many as checked.
+        CHECK(parser.feed("GET", 3) == lexy::accumulate_status::complete);
+    }
+    SUBCASE("incomplete")
+    {
+        CHECK(parser.feed("GET abc", 7) == lexy::accumulate_status::need_more);
+        CHECK(parser.check() == lexy::accumulate_status::need_more);
+        check_same(parser.finish(lexy::count), one_shot("GET abc"));
+    }
+    SUBCASE("large")
+    {
+        // Grows beyond the initial buffer.
+        std::string name(4000, 'a');
+        CHECK(parser.feed("GET ", 4) == lexy::accumulate_status::need_more);
+        for (auto i = std::size_t(0); i < name.size(); i += 1000)
+            CHECK(parser.feed(name.data() + i, 1000) == lexy::accumulate_status::need_more);
+        CHECK(parser.feed("\n", 1) == lexy::accumulate_status::need_more);
+        CHECK(parser.check() == lexy::accumulate_status::complete);
+        CHECK(parser.finish(lexy::count).value() == 4000);
+    }
+}
@@ -0,0 +1,129 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <lexy/action/batch_parse.hpp>
+
+#include <doctest/doctest.h>
+#include <lexy/callback.hpp>
+#include <lexy/dsl/ascii.hpp>
+#include <lexy/dsl/eof.hpp>
+#include <lexy/dsl/identifier.hpp>
+#include <lexy/dsl/integer.hpp>
+#include <lexy/dsl/sequence.hpp>
+#include <lexy/input/string_input.hpp>
+#include <lexy/memory_resource.hpp>
+#include <string>
+
+namespace
+{
+namespace dsl = lexy::dsl;
+
+struct number_p
+{
+    static constexpr auto name = "number";
+
+    static constexpr auto rule  = dsl::integer<int>(dsl::digits<>) + dsl::eof;
+    static constexpr auto value = lexy::forward<int>;
+};
+
+struct void_p
+{
+    static constexpr auto rule  = dsl::digits<> + dsl::eof;
+    static constexpr auto value = lexy::noop;
+};
+
+using arena_string
+    = std::basic_string<char, std::char_traits<char>,
+                        lexy::resource_allocator<char, lexy::arena_resource<>>>;
+
+struct string_p
+{
+    static constexpr auto rule  = dsl::identifier(dsl::ascii::alpha) + dsl::eof;
+    static constexpr auto value = lexy::as_string<arena_string>;
+};
+
+using input_t = lexy::string_input<lexy::default_encoding>;
+} // namespace
+
+TEST_CASE("batch_parser")
+{
+    SUBCASE("noop")
+    {
+        lexy::batch_parser<number_p, input_t> parser;
+
+        auto ok = parser.parse(lexy::zstring_input("42"));
+        CHECK(ok.is_success());
+        CHECK(!ok.is_error());
+        CHECK(ok.has_value());
+        CHECK(ok.value() == 42);
+        CHECK(ok.error_count() == 0);
+
+        auto failed = parser.parse(lexy::zstring_input("4x"));
+        CHECK(failed.is_error());
+        CHECK(failed.is_fatal_error());
+        CHECK(!failed.has_value());
+        CHECK(failed.error_count() == 1);
+
+        // The errors of the previous parse are gone.
+        auto ok_again = parser.parse(lexy::zstring_input("11"));
+        CHECK(ok_again.is_success());
+        CHECK(ok_again.value() == 11);
+    }
+    SUBCASE("callback")
+    {
+        auto callback = lexy::callback<const char*>(
+            [](const auto& context, const auto&) { return context.production(); });
+        lexy::batch_parser<number_p, input_t, decltype(callback)> parser(callback);
+
+        auto ok = parser.parse(lexy::zstring_input("42"));
+        CHECK(ok);
+        CHECK(ok.errors().empty());
+
+        auto error = parser.parse(lexy::zstring_input("x"));
+        CHECK(!error);
+        CHECK(error.error_count() == 1);
+        REQUIRE(error.errors().size() == 1);
+        CHECK(error.errors()[0] == lexy::_detail::string_view("number"));
+
+        // The error container is re-used.
+        auto data     = error.errors().data();
+        auto error2   = parser.parse(lexy::zstring_input("y"));
+        CHECK(error2.error_count() == 1);
+        CHECK(error2.errors().data() == data);
+    }
+    SUBCASE("void callback")
+    {
+        auto count    = 0;
+        auto callback = lexy::callback([&](const auto&, const auto&) { ++count; });
+        lexy::batch_parser<void_p, input_t, decltype(callback)> parser(callback);
+
+        auto ok = parser.parse(lexy::zstring_input("42"));
+        CHECK(ok);
+        CHECK(count == 0);
+
+        auto error = parser.parse(lexy::zstring_input("x"));
+        CHECK(!error);
+        CHECK(error.error_count() == 1);
+        CHECK(count == 1);
+    }
+    SUBCASE("arena state")
+    {
+        lexy::arena_resource<> arena;
+        auto                   state = lexy::with_arena(arena);
+        using noop_callback = LEXY_DECAY_DECLTYPE(lexy::noop);
+        lexy::batch_parser<string_p, input_t, noop_callback, decltype(state)> parser(state);
+
+        auto first = parser.parse(lexy::zstring_input("abcdefghijklmnopqrstuvwxyz"));
+        REQUIRE(first);
+        CHECK(first.value() == "abcdefghijklmnopqrstuvwxyz");
+        CHECK(first.value().get_allocator().resource() == &arena);
+        auto data = first.value().data();
+
+        // The arena is reset, so the second value re-uses the memory of the first one.
+        auto second = parser.parse(lexy::zstring_input("zyxwvutsrqponmlkjihgfedcba"));
+        REQUIRE(second);
+        CHECK(second.value() == "zyxwvutsrqponmlkjihgfedcba");
+        CHECK(second.value().data() == data);
+    }
+}
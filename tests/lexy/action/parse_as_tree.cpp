@@ -5,9 +5,11 @@
 #include <lexy/action/parse_as_tree.hpp>
 
 #include <doctest/doctest.h>
+#include <lexy/callback/adapter.hpp>
 #include <lexy/dsl.hpp>
 #include <lexy/input/string_input.hpp>
 #include <lexy_ext/parse_tree_doctest.hpp>
+#include <vector>
 
 namespace
 {
@@ -147,6 +149,29 @@ TEST_CASE("parse_as_tree")
         // clang-format on
         CHECK(tree == expected);
     }
+    SUBCASE("whitespace elided")
+    {
+        auto input  = lexy::zstring_input("123 ( abc //  \n) 321");
+        auto result = lexy::parse_as_tree<root_p, lexy::whitespace_elided_parse_tree>(tree, input,
+                                                                                     lexy::noop);
+        CHECK(result);
+
+        // clang-format off
+        auto expected = lexy_ext::parse_tree_desc<token_kind>(root_p{})
+            .token(token_kind::a, "123")
+            .production(child_p{})
+                .token(token_kind::b, "(")
+                .production("abc_p")
+                    .token(token_kind::c, "abc")
+                    .finish()
+                .token(token_kind::b, ")")
+                .finish()
+            .token(token_kind::a, "321")
+            .token(lexy::eof_token_kind, "");
+        // clang-format on
+        CHECK(tree == expected);
+        CHECK(tree.size() == 9);
+    }
     SUBCASE("failure")
     {
         tree = parse_tree::builder(root_p{}).finish();
@@ -165,6 +190,7 @@ TEST_CASE("parse_as_tree")
         auto input  = lexy::zstring_input("123(abxxx)321");
         auto result = lexy::parse_as_tree<root_p>(tree, input, lexy::noop);
         CHECK(!result);
+        CHECK(result.error_count() == 1);
         // clang-format off
         auto expected = lexy_ext::parse_tree_desc<token_kind>(root_p{})
             .token(token_kind::a, "123")
@@ -178,5 +204,17 @@ TEST_CASE("parse_as_tree")
         // clang-format on
         CHECK(tree == expected);
     }
-}
+    SUBCASE("error callback")
+    {
+        auto callback = lexy::collect<std::vector<const char*>>(
+            lexy::callback<const char*>([](const auto& context, const auto&) {
+                return context.production();
+            }));
 
+        auto input  = lexy::zstring_input("123(abxxx)321");
+        auto result = lexy::parse_as_tree<root_p>(tree, input, callback);
+        CHECK(!result);
+        REQUIRE(result.error_count() == 1);
+        CHECK(result.errors()[0] == lexy::production_name<abc_p>());
+    }
+}
@@ -0,0 +1,140 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <lexy/ast.hpp>
+
+#include <doctest/doctest.h>
+#include <lexy/action/parse.hpp>
+#include <lexy/callback/forward.hpp>
+#include <lexy/dsl/brackets.hpp>
+#include <lexy/dsl/capture.hpp>
+#include <lexy/dsl/digit.hpp>
+#include <lexy/dsl/list.hpp>
+#include <lexy/dsl/option.hpp>
+#include <lexy/dsl/production.hpp>
+#include <lexy/dsl/separator.hpp>
+#include <string>
+#include <vector>
+
+namespace
+{
+enum class kind
+{
+    number,
+    pair,
+    array,
+};
+
+using ast_t = lexy::flat_ast<kind>;
+
+template <typename Ast>
+std::string text(const Ast& ast, lexy::ast_node_id node)
+{
+    auto lex = ast.text(node);
+    return std::string(lex.begin(), lex.end());
+}
+
+std::vector<kind> child_kinds(const ast_t& ast, lexy::ast_node_id node)
+{
+    std::vector<kind> result;
+    for (auto child : ast.children(node))
+        result.push_back(ast.kind(child));
+    return result;
+}
+
+struct number
+{
+    static constexpr auto rule  = lexy::dsl::capture(lexy::dsl::digits<>);
+    static constexpr auto value = lexy::ast_node<kind::number>;
+};
+
+struct pair
+{
+    static constexpr auto rule = lexy::dsl::parenthesized(
+        lexy::dsl::p<number> + lexy::dsl::lit_c<','> + lexy::dsl::p<number>);
+    static constexpr auto value = lexy::ast_node<kind::pair>;
+};
+
+struct array
+{
+    struct item
+    {
+        static constexpr auto rule
+            = lexy::dsl::p<number> | lexy::dsl::p<pair> | lexy::dsl::recurse_branch<array>;
+        static constexpr auto value = lexy::forward<lexy::ast_node_id>;
+    };
+
+    static constexpr auto rule
+        = lexy::dsl::square_bracketed.opt_list(lexy::dsl::p<item>,
+                                               lexy::dsl::sep(lexy::dsl::lit_c<','>));
+    static constexpr auto value = lexy::ast_children<kind::array>;
+};
+} // namespace
+
+TEST_CASE("flat_ast")
+{
+    ast_t ast;
+    CHECK(ast.empty());
+
+    auto a = ast.create_node(kind::number);
+    auto b = ast.create_node(kind::number);
+    ast.set_text(b, "42", "42" + 2);
+    ast.link_siblings(a, b);
+    auto root = ast.create_node(kind::array, a);
+
+    CHECK(ast.size() == 3);
+    CHECK(ast.root() == root);
+    CHECK(ast.kind(root) == kind::array);
+    CHECK(ast.text(a).empty());
+    CHECK(text(ast, b) == "42");
+
+    CHECK(ast.first_child(root) == a);
+    CHECK(ast.next_sibling(a) == b);
+    CHECK(!ast.next_sibling(b));
+    CHECK(ast.children(a).empty());
+    CHECK(child_kinds(ast, root) == std::vector<kind>{kind::number, kind::number});
+
+    ast.clear();
+    CHECK(ast.empty());
+}
+
+TEST_CASE("ast_node and ast_children")
+{
+    ast_t ast;
+
+    auto input  = lexy::zstring_input("[1,(2,3),[],[4]]");
+    auto result = lexy::parse<array>(input, lexy::ast_builder(ast), lexy::noop);
+    REQUIRE(result);
+
+    auto root = result.value();
+    CHECK(root == ast.root());
+    CHECK(ast.size() == 8);
+    CHECK(child_kinds(ast, root) == std::vector<kind>{kind::number, kind::pair, kind::array,
+                                                      kind::array});
+
+    auto one = ast.first_child(root);
+    CHECK(text(ast, one) == "1");
+
+    auto pair = ast.next_sibling(one);
+    CHECK(text(ast, ast.first_child(pair)) == "2");
+    CHECK(text(ast, ast.next_sibling(ast.first_child(pair))) == "3");
+
+    auto empty = ast.next_sibling(pair);
+    CHECK(ast.children(empty).empty());
+
+    auto nested = ast.next_sibling(empty);
+    CHECK(text(ast, ast.first_child(nested)) == "4");
+    CHECK(!ast.next_sibling(nested));
+}
+
+TEST_CASE("flat_ast with arena")
+{
+    lexy::arena_resource<>                                         arena;
+    lexy::flat_ast<kind, lexy::default_encoding, decltype(arena)> ast(&arena);
+
+    auto input = lexy::zstring_input("[1,2,3]");
+    REQUIRE(lexy::parse<array>(input, lexy::ast_builder(ast), lexy::noop));
+    CHECK(ast.size() == 4);
+    CHECK(text(ast, ast.first_child(ast.root())) == "1");
+}
@@ -7,6 +7,7 @@
 #include <doctest/doctest.h>
 #include <lexy/callback/adapter.hpp>
 #include <lexy/dsl/option.hpp>
+#include <lexy/memory_resource.hpp>
 #include <set>
 #include <string>
 #include <vector>
@@ -99,6 +100,49 @@ TEST_CASE("as_list")
         auto result = LEXY_MOV(cb).finish();
         CHECK(result == decltype(result)({"a", "b", "c"}, 42));
     }
+    SUBCASE("parse state resource")
+    {
+        lexy::arena_resource<> arena;
+        auto                   state = lexy::with_arena(arena);
+
+        using allocator         = lexy::resource_allocator<std::string, lexy::arena_resource<>>;
+        constexpr auto callback = lexy::as_list<std::vector<std::string, allocator>>;
+
+        auto from_nullopt = callback[state](lexy::nullopt{});
+        CHECK(from_nullopt.empty());
+        CHECK(from_nullopt.get_allocator().resource() == &arena);
+
+        auto from_args = callback[state]("a", std::string("b"), "c");
+        CHECK(from_args == decltype(from_args)({"a", "b", "c"}, allocator(&arena)));
+        CHECK(from_args.get_allocator().resource() == &arena);
+
+        auto cb = callback.sink(state);
+        cb("a");
+        cb(std::string("b"));
+
+        auto result = LEXY_MOV(cb).finish();
+        CHECK(result == decltype(result)({"a", "b"}, allocator(&arena)));
+        CHECK(result.get_allocator().resource() == &arena);
+    }
+    SUBCASE("as_small_list")
+    {
+        constexpr auto callback = lexy::as_small_list<std::string, 2>;
+
+        auto from_args = callback("a", std::string("b"));
+        CHECK(from_args.size() == 2);
+        CHECK(from_args.is_inline());
+
+        auto cb = callback.sink();
+        cb.reserve(3);
+        cb("a");
+        cb(std::string("b"));
+        cb(std::size_t(1), 'c');
+
+        auto result = LEXY_MOV(cb).finish();
+        CHECK(result.size() == 3);
+        CHECK(result.capacity() == 3);
+        CHECK(result[2] == "c");
+    }
 }
 
 TEST_CASE("as_collection")
@@ -170,6 +214,27 @@ TEST_CASE("as_collection")
         auto result = LEXY_MOV(cb).finish();
         CHECK(result == decltype(result)({"a", "b", "c"}, 42));
     }
+    SUBCASE("parse state resource")
+    {
+        lexy::arena_resource<> arena;
+        auto                   state = lexy::with_arena(arena);
+
+        using allocator         = lexy::resource_allocator<std::string, lexy::arena_resource<>>;
+        using set               = std::set<std::string, std::less<>, allocator>;
+        constexpr auto callback = lexy::as_collection<set>;
+
+        auto from_args = callback[state]("a", std::string("b"), "c");
+        CHECK(from_args == set({"a", "b", "c"}, allocator(&arena)));
+        CHECK(from_args.get_allocator().resource() == &arena);
+
+        auto cb = callback.sink(state);
+        cb("a");
+        cb(std::string("b"));
+
+        auto result = LEXY_MOV(cb).finish();
+        CHECK(result == set({"a", "b"}, allocator(&arena)));
+        CHECK(result.get_allocator().resource() == &arena);
+    }
 }
 
 TEST_CASE("collect")
@@ -5,6 +5,7 @@
 #include <lexy/callback/object.hpp>
 
 #include <doctest/doctest.h>
+#include <lexy/memory_resource.hpp>
 #include <memory>
 
 TEST_CASE("construct")
@@ -85,5 +86,33 @@ TEST_CASE("new_")
         CHECK(result->a == 11);
         CHECK(result->b == 3.14f);
     }
+
+    SUBCASE("parse state")
+    {
+        // Even with a memory resource in the parse state, the object is allocated on the heap,
+        // so it can be deleted.
+        using state_t = lexy::arena_state<lexy::arena_resource<>>;
+        CHECK(!lexy::is_callback_state<decltype(lexy::new_<int>), state_t>);
+    }
 }
 
+TEST_CASE("arena_new")
+{
+    struct type
+    {
+        int   a;
+        float b;
+    };
+
+    lexy::arena_resource<> arena;
+    auto                   state = lexy::with_arena(arena);
+
+    auto  cb     = lexy::arena_new<type>;
+    type* result = cb[state](11, 3.14f);
+    CHECK(result->a == 11);
+    CHECK(result->b == 3.14f);
+
+    // The next allocation is right after it.
+    auto next = arena.allocate(1, 1);
+    CHECK(next == reinterpret_cast<unsigned char*>(result) + sizeof(type));
+}
@@ -5,9 +5,14 @@
 #include <lexy/callback/string.hpp>
 
 #include <doctest/doctest.h>
+#include <lexy/action/parse.hpp>
+#include <lexy/dsl/ascii.hpp>
+#include <lexy/dsl/delimited.hpp>
 #include <lexy/dsl/option.hpp>
 #include <lexy/input/string_input.hpp>
+#include <lexy/memory_resource.hpp>
 #include <string>
+#include <string_view>
 
 TEST_CASE("_detail::encode_code_point")
 {
@@ -81,6 +86,17 @@ TEST_CASE("_detail::encode_code_point")
     }
 }
 
+namespace
+{
+struct quoted_std_string
+{
+    static constexpr auto rule
+        = lexy::dsl::quoted(lexy::dsl::ascii::character,
+                            lexy::dsl::backslash_escape.capture(lexy::dsl::ascii::character));
+    static constexpr auto value = lexy::as_string<std::string>;
+};
+} // namespace
+
 TEST_CASE("as_string")
 {
     auto char_lexeme = [] {
@@ -155,6 +171,30 @@ TEST_CASE("as_string")
         std::string result = LEXY_MOV(sink).finish();
         CHECK(result == "aabcabchia\u00E4");
     }
+    SUBCASE("sink with many code points")
+    {
+        auto        sink = lexy::as_string<std::string, lexy::utf8_encoding>.sink();
+        std::string expected;
+        for (auto i = 0; i != 20; ++i)
+        {
+            sink(lexy::code_point(0x00E4));
+            sink(lexy::code_point(0x1F642));
+            expected += "\u00E4\U0001F642";
+        }
+        sink('a');
+        sink(lexy::code_point('b'));
+        expected += "ab";
+
+        std::string result = LEXY_MOV(sink).finish();
+        CHECK(result == expected);
+    }
+    SUBCASE("delimited with escaped delimiter")
+    {
+        auto input  = lexy::zstring_input(R"("hello\"world\"" rest)");
+        auto result = lexy::parse<quoted_std_string>(input, lexy::noop);
+        REQUIRE(result);
+        CHECK(result.value() == R"(hello"world")");
+    }
     SUBCASE("sink with allocator")
     {
         auto sink = lexy::as_string<std::string, lexy::utf8_encoding>.sink(std::allocator<int>());
@@ -168,5 +208,108 @@ TEST_CASE("as_string")
         std::string result = LEXY_MOV(sink).finish();
         CHECK(result == "aabcabchia\u00E4");
     }
+    SUBCASE("parse state resource")
+    {
+        lexy::arena_resource<> arena;
+        auto                   state = lexy::with_arena(arena);
+
+        using allocator   = lexy::resource_allocator<char, lexy::arena_resource<>>;
+        using string      = std::basic_string<char, std::char_traits<char>, allocator>;
+        constexpr auto cb = lexy::as_string<string, lexy::utf8_encoding>;
+
+        auto from_nullopt = cb[state](lexy::nullopt{});
+        CHECK(from_nullopt.empty());
+        CHECK(from_nullopt.get_allocator().resource() == &arena);
+
+        auto from_lexeme = cb[state](char_lexeme);
+        CHECK(from_lexeme == "abc");
+        CHECK(from_lexeme.get_allocator().resource() == &arena);
+
+        auto from_cp = cb[state](lexy::code_point(0x00E4));
+        CHECK(from_cp == "\u00E4");
+        CHECK(from_cp.get_allocator().resource() == &arena);
+
+        auto sink = cb.sink(state);
+        sink('a');
+        sink(char_lexeme);
+        auto result = LEXY_MOV(sink).finish();
+        CHECK(result == "aabc");
+        CHECK(result.get_allocator().resource() == &arena);
+    }
 }
 
+namespace
+{
+struct quoted_string
+{
+    static constexpr auto rule
+        = lexy::dsl::quoted(lexy::dsl::ascii::character,
+                            lexy::dsl::backslash_escape.capture(lexy::dsl::ascii::character));
+    static constexpr auto value = lexy::as_string_view<std::string_view>;
+};
+} // namespace
+
+TEST_CASE("as_string_view")
+{
+    auto input  = lexy::zstring_input("abc");
+    auto reader = input.reader();
+    reader.bump();
+    auto lexeme = lexy::lexeme(reader, input.data());
+
+    lexy::arena_resource<> arena;
+    auto                   state = lexy::with_arena(arena);
+
+    SUBCASE("callback")
+    {
+        constexpr auto callback = lexy::as_string_view<std::string_view>;
+        CHECK(callback(lexy::nullopt{}).empty());
+        CHECK(callback(std::string_view("test")) == "test");
+
+        auto from_lexeme = callback(lexeme);
+        CHECK(from_lexeme == "a");
+        CHECK(from_lexeme.data() == input.data());
+    }
+    SUBCASE("sink")
+    {
+        auto empty = lexy::as_string_view<std::string_view>.sink(state);
+        CHECK(LEXY_MOV(empty).finish().empty());
+
+        auto single = lexy::as_string_view<std::string_view>.sink(state);
+        single(lexeme);
+        auto single_result = LEXY_MOV(single).finish();
+        CHECK(single_result == "a");
+        CHECK(single_result.data() == input.data());
+
+        auto multiple = lexy::as_string_view<std::string_view, lexy::utf8_encoding>.sink(state);
+        multiple(lexeme);
+        multiple('b');
+        multiple(std::string_view("cd"));
+        multiple(lexy::code_point(0x00E4));
+        multiple(lexeme);
+        auto multiple_result = LEXY_MOV(multiple).finish();
+        CHECK(multiple_result == "abcd\u00E4a");
+        CHECK(multiple_result.data() != input.data());
+    }
+    SUBCASE("sink with size hint")
+    {
+        auto sink = lexy::as_string_view<std::u32string_view, lexy::utf32_encoding>.sink(state);
+        // A bogus hint is limited, so it doesn't overflow the size of the buffer.
+        sink.reserve(std::size_t(-1) / 2);
+        sink(U'a');
+        sink(lexy::code_point(0x1'F642));
+        CHECK(LEXY_MOV(sink).finish() == U"a\U0001F642");
+    }
+    SUBCASE("delimited")
+    {
+        auto without_escape = lexy::zstring_input(R"("hello world")");
+        auto result         = lexy::parse<quoted_string>(without_escape, state, lexy::noop);
+        REQUIRE(result);
+        CHECK(result.value() == "hello world");
+        CHECK(result.value().data() == without_escape.data() + 1);
+
+        auto with_escape = lexy::zstring_input(R"("hello\"world\"")");
+        result           = lexy::parse<quoted_string>(with_escape, state, lexy::noop);
+        REQUIRE(result);
+        CHECK(result.value() == R"(hello"world")");
+    }
+}
@@ -68,6 +68,34 @@ TEST_CASE("_detail::buffer_builder")
         REQUIRE(std::strncmp(buffer.read_data(), "abc", 3) == 0);
     }
 
+#if LEXY_HAS_MREMAP
+    SUBCASE("grow mapped")
+    {
+        while (!buffer.is_mapped())
+        {
+            std::memset(buffer.write_data(), '!', buffer.write_size());
+            buffer.commit(buffer.write_size());
+            buffer.grow();
+        }
+        REQUIRE(buffer.capacity() >= buffer.mapping_threshold_bytes);
+        REQUIRE(std::strncmp(buffer.read_data(), "abc", 3) == 0);
+        REQUIRE(buffer.read_data()[buffer.read_size() - 1] == '!');
+
+        auto old_cap  = buffer.capacity();
+        auto old_size = buffer.read_size();
+        buffer.grow();
+        REQUIRE(buffer.is_mapped());
+        REQUIRE(buffer.capacity() > old_cap);
+        REQUIRE(buffer.read_size() == old_size);
+        REQUIRE(std::strncmp(buffer.read_data(), "abc", 3) == 0);
+        REQUIRE(buffer.read_data()[old_size - 1] == '!');
+
+        std::memset(buffer.write_data(), '?', buffer.write_size());
+        buffer.commit(buffer.write_size());
+        REQUIRE(buffer.read_data()[buffer.read_size() - 1] == '?');
+    }
+#endif
+
     buffer.clear();
     REQUIRE(buffer.read_size() == 0);
     REQUIRE(buffer.write_size() == buffer.capacity());
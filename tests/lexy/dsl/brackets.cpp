@@ -48,3 +48,37 @@ TEST_CASE("dsl::brackets()")
     CHECK(equivalent_rules(dsl::parenthesized, brackets));
 }
 
+TEST_CASE("dsl::brackets().skip()")
+{
+    constexpr auto rule = dsl::round_bracketed.skip(LEXY_LIT("\"()\""));
+    CHECK(lexy::is_token_rule<decltype(rule)>);
+
+    constexpr auto callback = token_callback;
+
+    auto empty = LEXY_VERIFY("");
+    CHECK(empty.status == test_result::fatal_error);
+    CHECK(empty.trace == test_trace().expected_literal(0, "(", 0).cancel());
+
+    auto zero = LEXY_VERIFY("()");
+    CHECK(zero.status == test_result::success);
+    CHECK(zero.trace == test_trace().token("()"));
+    auto one = LEXY_VERIFY("(abc)");
+    CHECK(one.status == test_result::success);
+    CHECK(one.trace == test_trace().token("(abc)"));
+    auto nested = LEXY_VERIFY("(a(b)(c(d)))e");
+    CHECK(nested.status == test_result::success);
+    CHECK(nested.trace == test_trace().token("(a(b)(c(d)))"));
+
+    auto atom = LEXY_VERIFY("(a\"()\")");
+    CHECK(atom.status == test_result::success);
+    CHECK(atom.trace == test_trace().token("(a\"()\")"));
+    auto atom_unbalanced = LEXY_VERIFY("(\"()\"()");
+    CHECK(atom_unbalanced.status == test_result::fatal_error);
+    CHECK(atom_unbalanced.trace
+          == test_trace().error_token("(\"()\"()").expected_literal(7, ")", 0).cancel());
+
+    auto unterminated = LEXY_VERIFY("(a(b)");
+    CHECK(unterminated.status == test_result::fatal_error);
+    CHECK(unterminated.trace
+          == test_trace().error_token("(a(b)").expected_literal(5, ")", 0).cancel());
+}
@@ -0,0 +1,115 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <lexy/error_log.hpp>
+
+#include <doctest/doctest.h>
+#include <lexy/action/parse.hpp>
+#include <lexy/action/validate.hpp>
+#include <lexy/callback/constant.hpp>
+#include <lexy/dsl/ascii.hpp>
+#include <lexy/dsl/identifier.hpp>
+#include <lexy/dsl/literal.hpp>
+#include <lexy/dsl/recover.hpp>
+#include <lexy/dsl/sequence.hpp>
+#include <lexy/input/string_input.hpp>
+#include <lexy/input_location.hpp>
+
+namespace
+{
+struct my_error
+{
+    static constexpr auto name = "my error";
+};
+
+struct production
+{
+    static constexpr auto name = "production";
+
+    static constexpr auto id   = lexy::dsl::identifier(lexy::dsl::ascii::alpha);
+    static constexpr auto rule = lexy::dsl::try_(LEXY_LIT("abc"))
+                                 + lexy::dsl::try_(lexy::dsl::ascii::digit)
+                                 + lexy::dsl::try_(LEXY_KEYWORD("int", id))
+                                 + lexy::dsl::try_(LEXY_LIT("!").error<my_error>);
+
+    static constexpr auto value = lexy::constant(0);
+};
+
+using input_t = lexy::string_input<lexy::default_encoding>;
+} // namespace
+
+TEST_CASE("error_log")
+{
+    lexy::error_log<input_t> log;
+    CHECK(log.empty());
+
+    SUBCASE("no errors")
+    {
+        auto input  = lexy::zstring_input("abc1int!");
+        auto result = lexy::validate<production>(input, lexy::log_errors(log));
+        CHECK(result.is_success());
+        CHECK(result.error_count() == 0);
+        CHECK(log.empty());
+    }
+    SUBCASE("all errors")
+    {
+        auto input  = lexy::zstring_input("abxfloat!");
+        auto result = lexy::validate<production>(input, lexy::log_errors(log));
+        CHECK(result.is_recovered_error());
+        CHECK(result.error_count() == 4);
+        REQUIRE(log.size() == 4);
+
+        auto& literal = log[0];
+        CHECK(literal.kind() == lexy::error_kind::expected_literal);
+        CHECK(literal.production() == lexy::_detail::string_view("production"));
+        CHECK(literal.position() == input.data());
+        CHECK(literal.string() == lexy::_detail::string_view("abc"));
+        CHECK(literal.index() == 2);
+
+        auto& char_class = log[1];
+        CHECK(char_class.kind() == lexy::error_kind::expected_char_class);
+        CHECK(char_class.position() == input.data() + 2);
+        CHECK(char_class.character_class() == lexy::_detail::string_view("ASCII.digit"));
+
+        auto& keyword = log[2];
+        CHECK(keyword.kind() == lexy::error_kind::expected_keyword);
+        CHECK(keyword.begin() == input.data() + 2);
+        CHECK(keyword.end() == input.data() + 8);
+        CHECK(keyword.string() == lexy::_detail::string_view("int"));
+
+        auto& generic = log[3];
+        CHECK(generic.kind() == lexy::error_kind::generic);
+        CHECK(generic.message() == lexy::_detail::string_view("my error"));
+        CHECK(generic.position() == input.data() + 2);
+
+        // The location is only computed when needed.
+        auto location = lexy::get_input_location(input, generic.position());
+        CHECK(location.column_nr() == 3);
+    }
+    SUBCASE("reuse")
+    {
+        auto first  = lexy::zstring_input("ab1int!");
+        auto result = lexy::validate<production>(first, lexy::log_errors(log));
+        CHECK(result.error_count() == 1);
+        CHECK(log.size() == 1);
+
+        // Errors of multiple inputs are appended.
+        auto second = lexy::zstring_input("abc1int");
+        result      = lexy::validate<production>(second, lexy::log_errors(log));
+        CHECK(result.error_count() == 1);
+        REQUIRE(log.size() == 2);
+        CHECK(log[1].kind() == lexy::error_kind::generic);
+        CHECK(log[1].position() == second.data() + 7);
+
+        // After clearing, the memory is reused.
+        auto memory = &log[0];
+        log.clear();
+        CHECK(log.empty());
+
+        auto parse_result = lexy::parse<production>(first, lexy::log_errors(log));
+        CHECK(parse_result.error_count() == 1);
+        REQUIRE(log.size() == 1);
+        CHECK(&log[0] == memory);
+    }
+}
@@ -54,6 +54,10 @@ TEST_CASE("buffer")
         lexy::buffer<>::builder builder(3);
         std::memcpy(builder.data(), str, builder.size());
         verify(LEXY_MOV(builder).finish());
+        auto memory = static_cast<char*>(lexy::_detail::default_memory_resource::allocate(
+            lexy::buffer<>::allocation_size(3), alignof(char)));
+        std::memcpy(memory, str, 3);
+        verify(lexy::buffer<>::adopt(memory, 3));
     }
 #if LEXY_HAS_RESOURCE
     SUBCASE("constructor, default encoding, custom resource")
@@ -422,5 +426,85 @@ TEST_CASE("make_buffer")
         CHECK(big_bom.size() == 1);
         CHECK(big_bom.data()[0] == 0x00112233);
     }
+    SUBCASE("long input")
+    {
+        // Long enough that multiple code units are swapped at once, with some remaining.
+        unsigned char str[44];
+        for (auto i = 0u; i != sizeof(str); ++i)
+            str[i] = static_cast<unsigned char>(i);
+
+        auto utf16 = lexy::make_buffer_from_raw<lexy::utf16_encoding,
+                                                lexy::encoding_endianness::big>(str, 22);
+        REQUIRE(utf16.size() == 11);
+        for (auto i = 0u; i != utf16.size(); ++i)
+            CHECK(utf16.data()[i] == ((2 * i) << 8 | (2 * i + 1)));
+
+        auto utf32 = lexy::make_buffer_from_raw<lexy::utf32_encoding,
+                                                lexy::encoding_endianness::big>(str, sizeof(str));
+        REQUIRE(utf32.size() == 11);
+        for (auto i = 0u; i != utf32.size(); ++i)
+            CHECK(utf32.data()[i]
+                  == ((4 * i) << 24 | (4 * i + 1) << 16 | (4 * i + 2) << 8 | (4 * i + 3)));
+    }
 }
 
+TEST_CASE("make_buffer_transcoded")
+{
+    auto check = [](const auto& buffer, const char* expected) {
+        auto expected_size = std::strlen(expected);
+        CHECK(buffer.size() == expected_size);
+        CHECK(std::memcmp(buffer.data(), expected, expected_size) == 0);
+    };
+
+    SUBCASE("latin1")
+    {
+        const unsigned char str[] = {'H', 'e', 'l', 'l', 'o', ' ', 'W', 'o', 'r',
+                                     'l', 'd', ' ', 0xE9, 'a', 0xFF, 0x80, '!'};
+        auto                buffer
+            = lexy::make_buffer_transcoded<lexy::utf8_encoding>(str, sizeof(str),
+                                                                lexy::source_encoding::latin1);
+        check(buffer, "Hello World \xC3\xA9" "a\xC3\xBF\xC2\x80!");
+
+        auto empty
+            = lexy::make_buffer_transcoded<lexy::utf8_encoding>(str, 0,
+                                                                lexy::source_encoding::latin1);
+        CHECK(empty.size() == 0);
+    }
+    SUBCASE("utf16")
+    {
+        // "Hello, World ", U+00E9, U+20AC, U+1F600, an unpaired high and low surrogate, '!'.
+        const char16_t str[] = {u'H',   u'e',   u'l',   u'l',   u'o',   u',', u' ',
+                                u'W',   u'o',   u'r',   u'l',   u'd',   u' ', 0x00E9,
+                                0x20AC, 0xD83D, 0xDE00, 0xD800, u'a',   0xDC00, u'!'};
+        const auto expected = "Hello, World \xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80\xEF\xBF\xBD"
+                              "a\xEF\xBF\xBD!";
+
+        unsigned char little[2 + sizeof(str)];
+        unsigned char big[2 + sizeof(str)];
+        little[0] = 0xFF;
+        little[1] = 0xFE;
+        big[0]    = 0xFE;
+        big[1]    = 0xFF;
+        for (auto i = 0u; i != sizeof(str) / sizeof(char16_t); ++i)
+        {
+            little[2 + 2 * i]     = static_cast<unsigned char>(str[i] & 0xFF);
+            little[2 + 2 * i + 1] = static_cast<unsigned char>(str[i] >> 8);
+            big[2 + 2 * i]        = static_cast<unsigned char>(str[i] >> 8);
+            big[2 + 2 * i + 1]    = static_cast<unsigned char>(str[i] & 0xFF);
+        }
+
+        auto make = [](const unsigned char* memory, std::size_t size,
+                       lexy::source_encoding source) {
+            return lexy::make_buffer_transcoded<lexy::utf8_encoding>(memory, size, source);
+        };
+        check(make(little + 2, sizeof(str), lexy::source_encoding::utf16_little), expected);
+        check(make(big + 2, sizeof(str), lexy::source_encoding::utf16_big), expected);
+        check(make(little, sizeof(little), lexy::source_encoding::utf16_bom), expected);
+        check(make(big, sizeof(big), lexy::source_encoding::utf16_bom), expected);
+        check(make(big + 2, sizeof(str), lexy::source_encoding::utf16_bom), expected);
+
+        // A high surrogate at the end is unpaired as well.
+        check(make(big + 2, 2 * 16, lexy::source_encoding::utf16_big),
+              "Hello, World \xC3\xA9\xE2\x82\xAC\xEF\xBF\xBD");
+    }
+}
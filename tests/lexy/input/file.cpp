@@ -6,7 +6,11 @@
 #include <lexy/input/file.hpp>
 
 #include <cstdio>
+#include <cstring>
 #include <doctest/doctest.h>
+#include <lexy/_detail/buffer_builder.hpp>
+#include <string>
+#include <vector>
 
 #if defined(__has_include) && __has_include(<memory_resource>)
 #    include <memory_resource>
@@ -192,10 +196,151 @@ TEST_CASE("read_file")
         reader.bump();
         CHECK(reader.peek() == lexy::utf16_encoding::eof());
     }
+    SUBCASE("transcoded")
+    {
+        const unsigned char data[] = {'a', 0xE9, 'b', 0x00};
+        write_test_data(reinterpret_cast<const char*>(data));
+
+        auto result
+            = lexy::read_file_transcoded<lexy::utf8_encoding>(test_file_name,
+                                                              lexy::source_encoding::latin1);
+        REQUIRE(result);
+        CHECK(result.buffer().size() == 4);
+        CHECK(std::memcmp(result.buffer().data(), "a\xC3\xA9" "b", 4) == 0);
+
+        std::remove(test_file_name);
+        auto missing
+            = lexy::read_file_transcoded<lexy::utf8_encoding>(test_file_name,
+                                                              lexy::source_encoding::latin1);
+        CHECK(!missing);
+        CHECK(missing.error() == lexy::file_error::file_not_found);
+    }
+
+    std::remove(test_file_name);
+}
+
+TEST_CASE("huge_page_resource")
+{
+    const std::size_t sizes[] = {16, 2 * 1024 * 1024, 3 * 1024 * 1024 + 1};
+    for (auto size : sizes)
+    {
+        auto memory = static_cast<char*>(lexy::huge_page_resource::allocate(size, 1));
+        REQUIRE(memory != nullptr);
+        std::memset(memory, 'a', size);
+        CHECK(memory[size - 1] == 'a');
+        lexy::huge_page_resource::deallocate(memory, size, 1);
+    }
+
+    std::remove(test_file_name);
+    {
+        auto file = std::fopen(test_file_name, "wb");
+        for (auto i = 0; i != 3 * 1024 * 1024; ++i)
+            std::fputc('a', file);
+        std::fclose(file);
+    }
+
+    auto result = lexy::read_file<lexy::default_encoding, lexy::encoding_endianness::bom,
+                                  lexy::huge_page_resource>(test_file_name);
+    REQUIRE(result);
+    CHECK(result.buffer().size() == 3 * 1024 * 1024);
+    CHECK(result.buffer().data()[3 * 1024 * 1024 - 1] == 'a');
 
     std::remove(test_file_name);
 }
 
+#if LEXY_HAS_MREMAP
+TEST_CASE("huge_page_resource adopting mapping of buffer_builder")
+{
+    using buffer_t = lexy::buffer<lexy::utf8_encoding, lexy::huge_page_resource>;
+
+    lexy::_detail::buffer_builder<char> builder;
+    while (!builder.is_mapped())
+    {
+        std::memset(builder.write_data(), 'a', builder.write_size());
+        builder.commit(builder.write_size());
+        builder.grow();
+    }
+
+    // The library decides how big the mapping has to be, so that it can unmap it again.
+    auto size         = builder.read_size();
+    auto mapping_size = lexy::_detail::huge_page_mapping_size(buffer_t::allocation_size(size));
+    if (mapping_size == 0)
+        return;
+    CHECK(mapping_size >= buffer_t::allocation_size(size));
+
+    auto memory = builder.release_mapping(mapping_size);
+    CHECK(!builder.is_mapped());
+    CHECK(builder.read_size() == 0);
+
+    auto buffer = buffer_t::adopt(reinterpret_cast<LEXY_CHAR8_T*>(memory), size);
+    CHECK(buffer.size() == size);
+    CHECK(buffer.data()[size - 1] == 'a');
+    CHECK(lexy::utf8_encoding::to_int_type(buffer.data()[size])
+          == lexy::utf8_encoding::eof());
+}
+#endif
+
+TEST_CASE("read_files")
+{
+    // One file for each size class, and one that doesn't exist.
+    const std::size_t sizes[] = {0, 3, 2 * 1024, 20 * 1024, 400 * 1024};
+
+    std::vector<std::string> names;
+    for (auto i = 0u; i != 6; ++i)
+    {
+        names.push_back("lexy-input-file-" + std::to_string(i) + ".test.delete-me");
+        std::remove(names.back().c_str());
+        if (i == 5)
+            break;
+
+        auto file = std::fopen(names.back().c_str(), "wb");
+        for (auto j = std::size_t(0); j != sizes[i]; ++j)
+            std::fputc('a' + int(j % 26), file);
+        std::fclose(file);
+    }
+
+    std::vector<const char*> paths;
+    for (auto& name : names)
+        paths.push_back(name.c_str());
+
+    std::vector<int> read_count(paths.size());
+    lexy::read_files(paths.data(), paths.size(), [&](std::size_t idx, auto&& result) {
+        REQUIRE(idx < paths.size());
+        ++read_count[idx];
+
+        if (idx == 5)
+        {
+            CHECK(!result);
+            CHECK(result.error() == lexy::file_error::file_not_found);
+            return;
+        }
+
+        REQUIRE(result);
+        REQUIRE(result.buffer().size() == sizes[idx]);
+
+        auto all_equal = true;
+        for (auto j = std::size_t(0); j != sizes[idx]; ++j)
+            if (result.buffer().data()[j] != 'a' + int(j % 26))
+                all_equal = false;
+        CHECK(all_equal);
+    });
+    CHECK(read_count == std::vector<int>(paths.size(), 1));
+
+    // The requests for the other files are still in flight when the callback throws.
+    std::vector<const char*> many_paths(64, paths[3]);
+    auto                     throw_count = 0;
+    CHECK_THROWS_AS(lexy::read_files(many_paths.data(), many_paths.size(),
+                                     [&](std::size_t, auto&&) {
+                                         ++throw_count;
+                                         throw 42;
+                                     }),
+                    int);
+    CHECK(throw_count == 1);
+
+    for (auto& name : names)
+        std::remove(name.c_str());
+}
+
 TEST_CASE("read_stdin")
 {
     // Here, we'll reassociate stdin with our test file.
@@ -270,6 +415,45 @@ TEST_CASE("read_stdin")
 
         CHECK(reader.peek() == lexy::default_encoding::eof());
     }
+    SUBCASE("huge")
+    {
+        {
+            auto file = std::fopen(test_file_name, "wb");
+            for (auto i = 0; i != 100 * 1024; ++i)
+                std::fputc('a', file);
+            for (auto i = 0; i != 100 * 1024; ++i)
+                std::fputc('b', file);
+            std::fclose(file);
+
+            auto result = std::freopen(test_file_name, "rb", stdin);
+            REQUIRE(result == stdin);
+        }
+
+        // Some of the input has already been consumed.
+        CHECK(std::fgetc(stdin) == 'a');
+
+        auto result = lexy::read_stdin();
+        REQUIRE(result);
+        REQUIRE(result.buffer().size() == 200 * 1024 - 1);
+
+        auto reader = result.buffer().reader();
+        for (auto i = 1; i != 100 * 1024; ++i)
+        {
+            if (reader.peek() != 'a')
+                break;
+            reader.bump();
+        }
+        for (auto i = 0; i != 100 * 1024; ++i)
+        {
+            if (reader.peek() != 'b')
+                break;
+            reader.bump();
+        }
+        CHECK(reader.peek() == lexy::default_encoding::eof());
+
+        // Everything has been consumed.
+        CHECK(std::fgetc(stdin) == EOF);
+    }
 #if LEXY_HAS_RESOURCE
     SUBCASE("custom encoding and resource")
     {
@@ -0,0 +1,300 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <lexy/memory_resource.hpp>
+
+#include <doctest/doctest.h>
+#include <lexy/action/parse.hpp>
+#include <lexy/action/parse_as_tree.hpp>
+#include <lexy/callback.hpp>
+#include <lexy/dsl/ascii.hpp>
+#include <lexy/dsl/identifier.hpp>
+#include <lexy/dsl/list.hpp>
+#include <lexy/dsl/literal.hpp>
+#include <lexy/dsl/production.hpp>
+#include <lexy/dsl/separator.hpp>
+#include <lexy/input/buffer.hpp>
+#include <lexy/input/string_input.hpp>
+#include <lexy/parse_tree.hpp>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct counting_resource
+{
+    std::size_t allocations   = 0;
+    std::size_t deallocations = 0;
+    std::size_t last_size     = 0;
+
+    void* allocate(std::size_t bytes, std::size_t alignment)
+    {
+        ++allocations;
+        last_size = bytes;
+        return lexy::_detail::default_memory_resource::allocate(bytes, alignment);
+    }
+
+    void deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept
+    {
+        ++deallocations;
+        lexy::_detail::default_memory_resource::deallocate(ptr, bytes, alignment);
+    }
+
+    friend bool operator==(const counting_resource& lhs, const counting_resource& rhs) noexcept
+    {
+        return &lhs == &rhs;
+    }
+};
+
+struct production
+{
+    static constexpr auto rule = lexy::dsl::identifier(lexy::dsl::ascii::alpha);
+};
+} // namespace
+
+TEST_CASE("arena_resource")
+{
+    counting_resource                       upstream;
+    lexy::arena_resource<counting_resource> arena(256, &upstream);
+    CHECK(arena.upstream() == &upstream);
+    CHECK(upstream.allocations == 0);
+
+    SUBCASE("allocate")
+    {
+        auto a = static_cast<char*>(arena.allocate(3, 1));
+        auto b = static_cast<char*>(arena.allocate(8, 8));
+        auto c = static_cast<char*>(arena.allocate(1, 1));
+        CHECK(upstream.allocations == 1);
+
+        CHECK(b >= a + 3);
+        CHECK(reinterpret_cast<std::uintptr_t>(b) % 8 == 0);
+        CHECK(c == b + 8);
+
+        auto over_aligned = arena.allocate(16, 64);
+        CHECK(reinterpret_cast<std::uintptr_t>(over_aligned) % 64 == 0);
+
+        // Bigger than a chunk, so it gets its own one.
+        auto big = static_cast<char*>(arena.allocate(1024, 1));
+        CHECK(upstream.allocations == 2);
+        big[1023] = 'a';
+
+        arena.release();
+        CHECK(upstream.deallocations == 2);
+    }
+    SUBCASE("deallocate")
+    {
+        auto a = arena.allocate(16, 1);
+        auto b = arena.allocate(16, 1);
+        CHECK(a != b);
+
+        // Only the most recent allocation is reused.
+        arena.deallocate(a, 16, 1);
+        auto c = arena.allocate(16, 1);
+        CHECK(c != a);
+        arena.deallocate(c, 16, 1);
+        CHECK(arena.allocate(16, 1) == c);
+    }
+    SUBCASE("reset")
+    {
+        auto first = arena.allocate(128, 1);
+        for (auto i = 0; i != 16; ++i)
+            arena.allocate(128, 1);
+        auto allocations = upstream.allocations;
+        CHECK(allocations > 1);
+
+        arena.reset();
+        CHECK(arena.allocate(128, 1) == first);
+        for (auto i = 0; i != 16; ++i)
+            arena.allocate(128, 1);
+        CHECK(upstream.allocations == allocations);
+        CHECK(upstream.deallocations == 0);
+
+        // An allocation that does not fit into a chunk we already have.
+        arena.reset();
+        arena.allocate(4096, 1);
+        CHECK(upstream.allocations == allocations + 1);
+        CHECK(arena.allocate(128, 1) != first);
+    }
+    SUBCASE("release")
+    {
+        for (auto i = 0; i != 16; ++i)
+            arena.allocate(128, 1);
+        CHECK(upstream.last_size > 256);
+
+        // The chunks start small again.
+        arena.release();
+        arena.allocate(128, 1);
+        CHECK(upstream.last_size == 256);
+    }
+    SUBCASE("buffer and parse tree")
+    {
+        using resource_t = lexy::arena_resource<counting_resource>;
+        using buffer_t   = lexy::buffer<lexy::default_encoding, resource_t>;
+        using tree_t     = lexy::parse_tree_for<buffer_t, void, resource_t>;
+
+        for (auto i = 0; i != 3; ++i)
+        {
+            {
+                buffer_t input("abc", 3, &arena);
+                tree_t   tree(&arena);
+
+                auto result = lexy::parse_as_tree<production>(tree, input, lexy::noop);
+                CHECK(result);
+                CHECK(!tree.empty());
+            }
+
+            arena.reset();
+        }
+        CHECK(upstream.allocations <= 2);
+    }
+
+    arena.release();
+    CHECK(upstream.deallocations == upstream.allocations);
+}
+
+TEST_CASE("arena_resource with default upstream")
+{
+    lexy::arena_resource<> arena;
+
+    auto memory = static_cast<char*>(arena.allocate(2 * arena.default_chunk_size, 1));
+    memory[0]   = 'a';
+    CHECK(arena.allocate(16, 16) != nullptr);
+
+    arena.reset();
+    CHECK(arena.allocate(16, 1) == memory);
+}
+
+namespace
+{
+template <typename T>
+using arena_allocator = lexy::resource_allocator<T, lexy::arena_resource<counting_resource>>;
+using arena_string    = std::basic_string<char, std::char_traits<char>, arena_allocator<char>>;
+
+struct node
+{
+    std::vector<arena_string, arena_allocator<arena_string>> names;
+};
+
+struct name
+{
+    static constexpr auto rule  = lexy::dsl::identifier(lexy::dsl::ascii::alpha);
+    static constexpr auto value = lexy::as_string<arena_string>;
+};
+
+struct names
+{
+    static constexpr auto rule
+        = lexy::dsl::list(lexy::dsl::p<name>, lexy::dsl::sep(lexy::dsl::lit_c<','>));
+    static constexpr auto value = lexy::as_list<decltype(node::names)> >> lexy::arena_new<node>;
+};
+} // namespace
+
+TEST_CASE("with_arena")
+{
+    counting_resource                       upstream;
+    lexy::arena_resource<counting_resource> arena(&upstream);
+
+    auto input  = lexy::zstring_input("abc,de,f");
+    auto result = lexy::parse<names>(input, lexy::with_arena(arena), lexy::noop);
+    REQUIRE(result);
+
+    node* value = result.value();
+    REQUIRE(value->names.size() == 3);
+    CHECK(value->names[0] == "abc");
+    CHECK(value->names[1] == "de");
+    CHECK(value->names[2] == "f");
+    CHECK(value->names.get_allocator().resource() == &arena);
+    CHECK(value->names[0].get_allocator().resource() == &arena);
+
+    // Everything fits into a single chunk of the arena.
+    CHECK(upstream.allocations == 1);
+}
+
+TEST_CASE("pooled_resource")
+{
+    counting_resource                        upstream;
+    lexy::pooled_resource<counting_resource> pool(4096, &upstream);
+    CHECK(pool.upstream() == &upstream);
+
+    SUBCASE("reuse")
+    {
+        auto a = pool.allocate(1000, 1);
+        CHECK(upstream.allocations == 1);
+        pool.deallocate(a, 1000, 1);
+        CHECK(upstream.deallocations == 0);
+        CHECK(pool.stats().bytes_cached == 1024);
+
+        // A similar size is in the same size class.
+        auto b = pool.allocate(900, 1);
+        CHECK(b == a);
+        CHECK(upstream.allocations == 1);
+        CHECK(pool.stats().bytes_cached == 0);
+
+        // A different one is not.
+        auto c = pool.allocate(600, 1);
+        CHECK(c != a);
+        CHECK(upstream.allocations == 2);
+
+        auto stats = pool.stats();
+        CHECK(stats.hits == 1);
+        CHECK(stats.misses == 2);
+
+        pool.deallocate(b, 900, 1);
+        pool.deallocate(c, 600, 1);
+        CHECK(pool.stats().bytes_cached == 1024 + 640);
+    }
+    SUBCASE("size classes")
+    {
+        for (auto size : {std::size_t(1), std::size_t(64), std::size_t(65), std::size_t(129),
+                          std::size_t(3000)})
+        {
+            auto memory = static_cast<char*>(pool.allocate(size, 1));
+            memory[size - 1] = 'a';
+            pool.deallocate(memory, size, 1);
+        }
+        // 1 and 64 are in the same size class, so the block is reused.
+        CHECK(pool.stats().bytes_cached == 64 + 80 + 160 + 3072);
+        CHECK(pool.stats().hits == 1);
+    }
+    SUBCASE("limit and trim")
+    {
+        auto a = pool.allocate(3000, 1);
+        auto b = pool.allocate(3000, 1);
+        auto c = pool.allocate(100, 1);
+        pool.deallocate(a, 3000, 1);
+        pool.deallocate(b, 3000, 1);
+        CHECK(pool.stats().bytes_cached == 3072);
+        CHECK(upstream.deallocations == 1);
+
+        pool.deallocate(c, 100, 1);
+        CHECK(pool.stats().bytes_cached == 3072 + 112);
+
+        // Trimming starts with the biggest blocks.
+        pool.trim(1000);
+        CHECK(pool.stats().bytes_cached == 112);
+        CHECK(upstream.deallocations == 2);
+    }
+    SUBCASE("over-aligned")
+    {
+        auto memory = pool.allocate(16, 256);
+        CHECK(reinterpret_cast<std::uintptr_t>(memory) % 256 == 0);
+        pool.deallocate(memory, 16, 256);
+        CHECK(pool.stats().bytes_cached == 0);
+        CHECK(upstream.deallocations == 1);
+    }
+    SUBCASE("buffer")
+    {
+        using buffer_t = lexy::buffer<lexy::default_encoding, decltype(pool)>;
+        for (auto i = 0; i != 3; ++i)
+        {
+            buffer_t input("abc", 3, &pool);
+            CHECK(input.size() == 3);
+        }
+        CHECK(upstream.allocations == 1);
+        CHECK(pool.stats().hits == 2);
+    }
+
+    pool.trim();
+    CHECK(upstream.deallocations == upstream.allocations);
+}
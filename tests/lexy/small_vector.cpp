@@ -0,0 +1,143 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <lexy/small_vector.hpp>
+
+#include <doctest/doctest.h>
+#include <lexy/action/parse.hpp>
+#include <lexy/callback/container.hpp>
+#include <lexy/dsl/ascii.hpp>
+#include <lexy/dsl/capture.hpp>
+#include <lexy/dsl/integer.hpp>
+#include <lexy/dsl/repeat.hpp>
+#include <lexy/input/string_input.hpp>
+#include <new>
+#include <string>
+
+namespace
+{
+struct throwing
+{
+    explicit throwing(bool do_throw)
+    {
+        if (do_throw)
+            throw 42;
+    }
+};
+} // namespace
+
+TEST_CASE("small_vector")
+{
+    lexy::small_vector<std::string, 2> vec;
+    CHECK(vec.empty());
+    CHECK(vec.capacity() == 2);
+    CHECK(vec.is_inline());
+
+    SUBCASE("inline")
+    {
+        vec.push_back("a");
+        vec.emplace_back(std::size_t(2), 'b');
+        CHECK(vec.size() == 2);
+        CHECK(vec.is_inline());
+        CHECK(vec[0] == "a");
+        CHECK(vec[1] == "bb");
+        CHECK(vec.front() == "a");
+        CHECK(vec.back() == "bb");
+
+        auto copy = vec;
+        CHECK(copy == vec);
+        CHECK(copy.is_inline());
+
+        auto moved = LEXY_MOV(vec);
+        CHECK(moved == copy);
+        CHECK(moved.is_inline());
+        CHECK(vec.empty());
+
+        moved.pop_back();
+        CHECK(moved.size() == 1);
+        CHECK(moved != copy);
+    }
+    SUBCASE("heap")
+    {
+        for (auto i = 0; i != 10; ++i)
+            vec.push_back(std::string(20, char('a' + i)));
+        CHECK(vec.size() == 10);
+        CHECK(!vec.is_inline());
+        for (auto i = 0; i != 10; ++i)
+            CHECK(vec[std::size_t(i)] == std::string(20, char('a' + i)));
+
+        // The argument refers to an element that is moved when growing.
+        vec.push_back(vec[0]);
+        CHECK(vec.back() == vec.front());
+
+        auto copy = vec;
+        CHECK(copy == vec);
+
+        auto data  = vec.data();
+        auto moved = LEXY_MOV(vec);
+        CHECK(moved.data() == data);
+        CHECK(vec.empty());
+        CHECK(vec.is_inline());
+
+        moved = copy;
+        CHECK(moved == copy);
+        moved.clear();
+        CHECK(moved.empty());
+        CHECK(moved.capacity() >= 11);
+    }
+    SUBCASE("reserve")
+    {
+        vec.push_back("a");
+        vec.reserve(1);
+        CHECK(vec.is_inline());
+
+        vec.reserve(5);
+        CHECK(!vec.is_inline());
+        CHECK(vec.capacity() == 5);
+        CHECK(vec[0] == "a");
+
+        CHECK_THROWS_AS(vec.reserve(vec.max_size() + 1), std::bad_array_new_length);
+        CHECK(vec.capacity() == 5);
+    }
+    SUBCASE("throwing constructor")
+    {
+        lexy::small_vector<throwing, 1> throwing_vec;
+        throwing_vec.emplace_back(false);
+
+        // The memory allocated for growing is freed again.
+        CHECK_THROWS_AS(throwing_vec.emplace_back(true), int);
+        CHECK(throwing_vec.size() == 1);
+        CHECK(throwing_vec.is_inline());
+    }
+}
+
+namespace
+{
+struct letters
+{
+    static constexpr auto rule = lexy::dsl::repeat(lexy::dsl::integer<int>(lexy::dsl::digits<>))
+                                     .list(lexy::dsl::capture(lexy::dsl::ascii::alpha));
+    static constexpr auto value = lexy::as_small_list<lexy::string_lexeme<>, 2>;
+};
+} // namespace
+
+TEST_CASE("as_small_list")
+{
+    auto short_input = lexy::zstring_input("2ab");
+    auto short_list  = lexy::parse<letters>(short_input, lexy::noop).value();
+    CHECK(short_list.size() == 2);
+    CHECK(short_list.is_inline());
+    CHECK(short_list[1].begin() == short_input.data() + 2);
+
+    // dsl::repeat() tells the sink the number of items upfront.
+    auto long_input = lexy::zstring_input("5abcde");
+    auto long_list  = lexy::parse<letters>(long_input, lexy::noop).value();
+    CHECK(long_list.size() == 5);
+    CHECK(long_list.capacity() == 5);
+
+    // A bogus number of items is only trusted up to a limit.
+    auto bogus_input  = lexy::zstring_input("999999999abc");
+    auto bogus_result = lexy::parse<letters>(bogus_input, lexy::noop);
+    CHECK(bogus_result.is_fatal_error());
+}
@@ -0,0 +1,114 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <lexy_ext/intern_table.hpp>
+
+#include <doctest/doctest.h>
+#include <lexy/action/parse.hpp>
+#include <lexy/dsl/ascii.hpp>
+#include <lexy/dsl/identifier.hpp>
+#include <lexy/dsl/symbol.hpp>
+#include <lexy/input/string_input.hpp>
+#include <lexy_ext/thread_pool.hpp>
+#include <string>
+#include <vector>
+
+namespace
+{
+lexy_ext::intern_table<> global_table;
+
+struct identifier
+{
+    static constexpr auto rule  = lexy::dsl::identifier(lexy::dsl::ascii::alpha);
+    static constexpr auto value = lexy_ext::as_interned(global_table);
+};
+
+constexpr auto keywords = lexy::symbol_table<const char*> //
+                              .map<LEXY_SYMBOL("fn")>("function")
+                              .map<LEXY_SYMBOL("let")>("variable");
+
+struct keyword
+{
+    static constexpr auto rule
+        = lexy::dsl::symbol<keywords>(lexy::dsl::identifier(lexy::dsl::ascii::alpha));
+    static constexpr auto value = lexy_ext::as_interned(global_table);
+};
+} // namespace
+
+TEST_CASE("intern_table")
+{
+    lexy_ext::intern_table<lexy::default_encoding, void, 4> table;
+    CHECK(table.size() == 0);
+
+    auto abc = table.intern("abc", 3);
+    auto de  = table.intern("de", 2);
+    auto ab  = table.intern("abcdef", 2);
+    CHECK(abc != de);
+    CHECK(abc != ab);
+    CHECK(table.intern("abc", 3) == abc);
+    CHECK(table.size() == 3);
+
+    CHECK(std::string(table.c_str(abc)) == "abc");
+    CHECK(table.length(abc) == 3);
+    CHECK(std::string(table.c_str(ab)) == "ab");
+
+    std::string str = "de";
+    CHECK(table.intern(str.begin(), str.end()) == de);
+
+    // Enough strings to grow the hash table of every shard.
+    std::vector<lexy_ext::interned_id> ids;
+    for (auto i = 0; i != 1000; ++i)
+    {
+        auto name = "name" + std::to_string(i);
+        ids.push_back(table.intern(name.data(), name.size()));
+    }
+    CHECK(table.size() == 1003);
+    for (auto i = 0; i != 1000; ++i)
+    {
+        auto name = "name" + std::to_string(i);
+        CHECK(table.intern(name.data(), name.size()) == ids[std::size_t(i)]);
+        CHECK(table.c_str(ids[std::size_t(i)]) == name);
+    }
+
+    // The ids are compact.
+    auto max_id = std::uint32_t(0);
+    for (auto id : ids)
+        if (std::uint32_t(id) > max_id)
+            max_id = std::uint32_t(id);
+    CHECK(max_id < 2 * 1003);
+}
+
+TEST_CASE("intern_table multiple threads")
+{
+    lexy_ext::intern_table<> table;
+    lexy_ext::thread_pool    pool(4);
+
+    std::vector<lexy_ext::interned_id> ids(4000);
+    pool.parallel_for(ids.size(), [&](std::size_t i) {
+        // Each string is interned by multiple threads.
+        auto name = "name" + std::to_string(i % 1000);
+        ids[i]    = table.intern(name.data(), name.size());
+    });
+
+    CHECK(table.size() == 1000);
+    for (auto i = 0u; i != ids.size(); ++i)
+    {
+        CHECK(ids[i] == ids[i % 1000]);
+        CHECK(table.c_str(ids[i]) == "name" + std::to_string(i % 1000));
+    }
+}
+
+TEST_CASE("as_interned")
+{
+    auto id = lexy::parse<identifier>(lexy::zstring_input("hello"), lexy::noop).value();
+    CHECK(std::string(global_table.c_str(id)) == "hello");
+    CHECK(lexy::parse<identifier>(lexy::zstring_input("hello"), lexy::noop).value() == id);
+
+    auto fn = lexy::parse<keyword>(lexy::zstring_input("fn"), lexy::noop).value();
+    CHECK(std::string(global_table.c_str(fn)) == "function");
+    CHECK(global_table.intern("function", 8) == fn);
+
+    constexpr auto callback = lexy_ext::as_interned(global_table);
+    CHECK(callback(id) == id);
+}
@@ -0,0 +1,112 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <lexy_ext/lazy_parse_tree.hpp>
+
+#include <doctest/doctest.h>
+#include <lexy/dsl.hpp>
+#include <lexy/input/string_input.hpp>
+
+namespace
+{
+namespace dsl = lexy::dsl;
+
+struct atom_p
+{
+    static constexpr auto rule = dsl::ascii::alpha;
+};
+
+struct list_p
+{
+    static constexpr auto rule
+        = dsl::round_bracketed.opt_list(dsl::p<atom_p> | dsl::recurse_branch<list_p>,
+                                        dsl::sep(dsl::comma));
+
+    static constexpr auto deferred = dsl::round_bracketed.skip();
+};
+
+struct root_p
+{
+    static constexpr auto whitespace = dsl::ascii::space;
+    static constexpr auto rule       = dsl::p<list_p> + dsl::eof;
+};
+
+template <typename Range>
+auto nth(Range range, std::size_t n)
+{
+    auto iter = range.begin();
+    while (n-- > 0)
+        ++iter;
+    return *iter;
+}
+} // namespace
+
+TEST_CASE("lazy_parse_tree")
+{
+    lexy_ext::lazy_parse_tree<lexy::string_input<>> tree;
+    CHECK(tree.empty());
+
+    SUBCASE("basic")
+    {
+        auto input  = lexy::zstring_input("(a, (b, c), (d, (e)))");
+        auto result = lexy_ext::parse_as_lazy_tree<root_p>(tree, input, lexy::noop);
+        CHECK(result);
+        CHECK(!tree.empty());
+
+        // The top-level list is skipped over entirely.
+        CHECK(tree.shallow_tree().size() == 4);
+        auto list = nth(tree.root().children(), 0);
+        CHECK(list.kind() == list_p{});
+        CHECK(tree.is_deferred(list));
+        CHECK(!tree.is_expanded(list));
+        CHECK(list.children().size() == 1);
+        CHECK(nth(list.children(), 0).lexeme().size() == input.size());
+
+        auto children = tree.children(list);
+        CHECK(tree.is_expanded(list));
+        CHECK(children.size() == 9);
+        CHECK(nth(children, 1).kind() == atom_p{});
+
+        auto inner = nth(children, 4);
+        CHECK(inner.kind() == list_p{});
+        CHECK(tree.is_deferred(inner));
+        CHECK(!tree.is_expanded(inner));
+        CHECK(tree.children(inner).size() == 6);
+        CHECK(tree.is_expanded(inner));
+
+        // Expanding again re-uses the existing tree.
+        CHECK(&tree.expand(list) == &tree.expand(list));
+        CHECK(tree.expansion_error_count() == 0);
+
+        // Tokens and atoms are never deferred.
+        CHECK(!tree.is_deferred(tree.root()));
+        CHECK(!tree.is_deferred(nth(children, 0)));
+        CHECK(!tree.is_deferred(nth(children, 1)));
+        CHECK(tree.children(nth(children, 1)).size() == 1);
+    }
+    SUBCASE("error in deferred production")
+    {
+        auto input  = lexy::zstring_input("(a, (b c))");
+        auto result = lexy_ext::parse_as_lazy_tree<root_p>(tree, input, lexy::noop);
+        CHECK(result);
+
+        auto list     = nth(tree.root().children(), 0);
+        auto children = tree.children(list);
+        CHECK(children.size() == 6);
+        CHECK(tree.expansion_error_count() == 0);
+
+        // The error is only detected once the production is expanded.
+        auto inner = nth(children, 4);
+        CHECK(tree.is_deferred(inner));
+        CHECK(!tree.expand(inner).empty());
+        CHECK(tree.expansion_error_count() == 1);
+    }
+    SUBCASE("unbalanced brackets")
+    {
+        auto input  = lexy::zstring_input("(a, (b)");
+        auto result = lexy_ext::parse_as_lazy_tree<root_p>(tree, input, lexy::noop);
+        CHECK(!result);
+        CHECK(result.error_count() == 1);
+    }
+}
@@ -0,0 +1,162 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <lexy_ext/parallel_parse.hpp>
+
+#include <doctest/doctest.h>
+#include <lexy/callback.hpp>
+#include <lexy/dsl.hpp>
+#include <lexy/input/string_input.hpp>
+#include <lexy_ext/thread_pool.hpp>
+#include <string>
+
+namespace
+{
+namespace dsl = lexy::dsl;
+
+struct record
+{
+    static constexpr auto rule  = dsl::integer<int>(dsl::digits<>);
+    static constexpr auto value = lexy::forward<int>;
+};
+
+struct number
+{
+    static constexpr auto rule  = dsl::integer<int>(dsl::digits<>);
+    static constexpr auto value = lexy::forward<int>;
+};
+
+// Its whitespace is also skipped in number, as it is the root production.
+struct spaced_record
+{
+    static constexpr auto whitespace = dsl::ascii::blank;
+
+    static constexpr auto rule  = dsl::p<number> + dsl::lit_c<','> + dsl::p<number>;
+    static constexpr auto value = lexy::callback<int>([](int a, int b) { return 10 * a + b; });
+};
+
+constexpr auto separator = dsl::lit_c<'\n'>;
+
+// Generates "0\n1\n2\n..." with an invalid record at every multiple of 100.
+std::string generate(int count)
+{
+    std::string result;
+    for (auto i = 0; i != count; ++i)
+    {
+        if (i > 0)
+            result += '\n';
+
+        if (i % 100 == 99)
+            result += 'x';
+        else
+            result += std::to_string(i);
+    }
+    return result;
+}
+} // namespace
+
+TEST_CASE("parallel_parse()")
+{
+    lexy_ext::sequential_executor sequential;
+    lexy_ext::thread_pool         pool(4);
+
+    SUBCASE("empty")
+    {
+        auto input  = lexy::zstring_input("");
+        auto result = lexy_ext::parallel_parse<record>(input, separator, sequential,
+                                                      lexy::as_list<std::vector<int>>, lexy::noop);
+        CHECK(result);
+        CHECK(result.record_count() == 0);
+        CHECK(result.value().empty());
+    }
+    SUBCASE("single chunk")
+    {
+        auto input  = lexy::zstring_input("1\n22\n333\n");
+        auto result = lexy_ext::parallel_parse<record>(input, separator, sequential,
+                                                      lexy::as_list<std::vector<int>>, lexy::noop);
+        CHECK(result);
+        CHECK(result.record_count() == 3);
+        CHECK(result.value() == std::vector<int>{1, 22, 333});
+    }
+    SUBCASE("many chunks")
+    {
+        auto str   = generate(1000);
+        auto input = lexy::string_input<lexy::default_encoding>(str.data(), str.size());
+
+        auto callback = lexy::callback<std::size_t>([&](const auto& context, const auto& error) {
+            // The context refers to the entire input.
+            CHECK(context.input().data() == str.data());
+            return std::size_t(error.position() - str.data());
+        });
+
+        for (auto chunk_size : {std::size_t(1), std::size_t(64), std::size_t(1000)})
+        {
+            auto error_cb = lexy::collect<std::vector<std::size_t>>(callback);
+            auto result = lexy_ext::parallel_parse<record>(input, separator, pool,
+                                                           lexy::as_list<std::vector<int>>, error_cb,
+                                                           chunk_size);
+            CHECK(!result);
+            CHECK(result.record_count() == 1000);
+            CHECK(result.error_count() == 10);
+
+            auto values_in_order = true;
+            auto expected        = 0;
+            for (auto value : result.value())
+            {
+                if (expected % 100 == 99)
+                    ++expected;
+                if (value != expected)
+                    values_in_order = false;
+                ++expected;
+            }
+            CHECK(result.value().size() == 990);
+            CHECK(values_in_order);
+
+            auto& errors          = result.errors();
+            auto  errors_in_order = true;
+            for (auto i = 0u; i != errors.size(); ++i)
+            {
+                if (str[errors[i]] != 'x')
+                    errors_in_order = false;
+                else if (i > 0 && errors[i - 1] >= errors[i])
+                    errors_in_order = false;
+            }
+            CHECK(errors_in_order);
+        }
+    }
+    SUBCASE("whitespace")
+    {
+        const char* lines[] = {"1 , 2", "3, 4", "5\t,6 "};
+
+        std::string      str;
+        std::vector<int> expected;
+        for (auto line : lines)
+        {
+            if (!str.empty())
+                str += '\n';
+            str += line;
+
+            auto sequential = lexy::parse<spaced_record>(lexy::zstring_input(line), lexy::noop);
+            REQUIRE(sequential);
+            expected.push_back(sequential.value());
+        }
+
+        auto input  = lexy::string_input<lexy::default_encoding>(str.data(), str.size());
+        auto result = lexy_ext::parallel_parse<spaced_record>(input, separator, pool,
+                                                             lexy::as_list<std::vector<int>>,
+                                                             lexy::noop, 1);
+        CHECK(result);
+        CHECK(result.record_count() == 3);
+        CHECK(result.value() == expected);
+    }
+    SUBCASE("trailing input")
+    {
+        auto input  = lexy::zstring_input("1\n2x\n3");
+        auto result = lexy_ext::parallel_parse<record>(input, separator, pool,
+                                                      lexy::as_list<std::vector<int>>, lexy::noop);
+        CHECK(!result);
+        CHECK(result.errors() == 1);
+        CHECK(result.value() == std::vector<int>{1, 3});
+    }
+}
@@ -4,8 +4,10 @@
 
 #include <lexy_ext/parse_tree_algorithm.hpp>
 
+#include <atomic>
 #include <doctest/doctest.h>
 #include <lexy/input/string_input.hpp>
+#include <lexy_ext/thread_pool.hpp>
 
 namespace
 {
@@ -297,3 +299,79 @@ TEST_CASE("node_position()")
     REQUIRE(prod_count == 6);
 }
 
+
+TEST_CASE("parallel_for_each_subtree()")
+{
+    using parse_tree = lexy::parse_tree_for<lexy::string_input<>, token_kind>;
+    auto input       = lexy::zstring_input("123(abc)321");
+
+    auto tree = [&] {
+        parse_tree::builder builder(root_p{});
+        builder.token(token_kind::a, input.data(), input.data() + 3);
+
+        auto child = builder.start_production(child_p{});
+
+        auto child2 = builder.start_production(child_p{});
+        builder.token(token_kind::b, input.data() + 3, input.data() + 4);
+        builder.finish_production(LEXY_MOV(child2));
+
+        builder.token(token_kind::c, input.data() + 4, input.data() + 7);
+        builder.token(token_kind::b, input.data() + 7, input.data() + 8);
+        builder.finish_production(LEXY_MOV(child));
+
+        builder.token(token_kind::a, input.data() + 8, input.data() + 11);
+
+        child = builder.start_production(child_p{});
+        builder.finish_production(LEXY_MOV(child));
+
+        return LEXY_MOV(builder).finish();
+    }();
+    CHECK(!tree.empty());
+
+    SUBCASE("production")
+    {
+        lexy_ext::sequential_executor executor;
+
+        auto count = 0;
+        auto size  = std::size_t(0);
+        lexy_ext::parallel_for_each_subtree(
+            tree, child_p{},
+            [&](auto node) {
+                CHECK(node.kind() == child_p{});
+                ++count;
+                for (auto token : lexy_ext::tokens(tree, node))
+                    size += token.lexeme().size();
+            },
+            executor);
+        // The nested child_p is part of the first one.
+        CHECK(count == 2);
+        CHECK(size == 5);
+    }
+    SUBCASE("token kind")
+    {
+        lexy_ext::sequential_executor executor;
+
+        doctest::String result;
+        lexy_ext::parallel_for_each_subtree(
+            tree, token_kind::b,
+            [&](auto node) {
+                result += doctest::String(node.lexeme().data(), unsigned(node.lexeme().size()));
+            },
+            executor);
+        CHECK(result == "()");
+    }
+    SUBCASE("thread_pool")
+    {
+        lexy_ext::thread_pool executor(4);
+
+        std::atomic<int> count(0);
+        lexy_ext::parallel_for_each_subtree(
+            tree, [](auto node) { return node.kind().is_token(); },
+            [&](auto node) {
+                CHECK(!node.lexeme().empty());
+                ++count;
+            },
+            executor);
+        CHECK(count == 5);
+    }
+}
@@ -0,0 +1,157 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <lexy_ext/parse_tree_query.hpp>
+
+#include <doctest/doctest.h>
+#include <lexy/input/string_input.hpp>
+
+namespace
+{
+enum class token_kind
+{
+    identifier,
+    comma,
+};
+
+const char* token_kind_name(token_kind k)
+{
+    switch (k)
+    {
+    case token_kind::identifier:
+        return "identifier";
+    case token_kind::comma:
+        return "comma";
+    }
+
+    return "";
+}
+
+struct function
+{
+    static constexpr auto name = "function";
+    static constexpr auto rule = 0; // Need a rule to identify as production.
+};
+
+struct parameter_list
+{
+    static constexpr auto name = "parameter_list";
+    static constexpr auto rule = 0;
+};
+
+struct file
+{
+    static constexpr auto name = "ns::file";
+    static constexpr auto rule = 0;
+};
+} // namespace
+
+TEST_CASE("parse_tree_query")
+{
+    using parse_tree = lexy::parse_tree_for<lexy::string_input<>, token_kind>;
+    auto input       = lexy::zstring_input("f a,b g");
+
+    // file
+    //   function
+    //     identifier "f"
+    //     parameter_list
+    //       identifier "a"
+    //       comma
+    //       identifier "b"
+    //   function
+    //     identifier "g"
+    //     parameter_list
+    auto tree = [&] {
+        parse_tree::builder builder(file{});
+
+        auto fn = builder.start_production(function{});
+        builder.token(token_kind::identifier, input.data(), input.data() + 1);
+        auto params = builder.start_production(parameter_list{});
+        builder.token(token_kind::identifier, input.data() + 2, input.data() + 3);
+        builder.token(token_kind::comma, input.data() + 3, input.data() + 4);
+        builder.token(token_kind::identifier, input.data() + 4, input.data() + 5);
+        builder.finish_production(LEXY_MOV(params));
+        builder.finish_production(LEXY_MOV(fn));
+
+        fn = builder.start_production(function{});
+        builder.token(token_kind::identifier, input.data() + 6, input.data() + 7);
+        params = builder.start_production(parameter_list{});
+        builder.finish_production(LEXY_MOV(params));
+        builder.finish_production(LEXY_MOV(fn));
+
+        return LEXY_MOV(builder).finish();
+    }();
+    REQUIRE(!tree.empty());
+
+    auto lexemes = [&](const char* query) {
+        lexy_ext::parse_tree_query q(query);
+        CHECK(q.is_valid());
+
+        doctest::String result;
+        for (auto node : q.find_all(tree))
+        {
+            if (node.kind().is_token())
+                result += doctest::String(node.lexeme().data(), unsigned(node.lexeme().size()));
+            else
+                result += "<prod>";
+        }
+        return result;
+    };
+
+    SUBCASE("single name")
+    {
+        CHECK(lexemes("identifier") == "fabg");
+        CHECK(lexemes("comma") == ",");
+        CHECK(lexemes("function") == "<prod><prod>");
+        CHECK(lexemes("file") == "<prod>");
+        CHECK(lexemes("ns::file") == "<prod>");
+        CHECK(lexemes("s::file") == "");
+        CHECK(lexemes("unknown") == "");
+        CHECK(lexemes("*") == "<prod><prod>f<prod>a,b<prod>g<prod>");
+    }
+    SUBCASE("descendant")
+    {
+        CHECK(lexemes("function identifier") == "fabg");
+        CHECK(lexemes("file function identifier") == "fabg");
+        CHECK(lexemes("parameter_list identifier") == "ab");
+        CHECK(lexemes("identifier identifier") == "");
+    }
+    SUBCASE("child")
+    {
+        CHECK(lexemes("function > identifier") == "fg");
+        CHECK(lexemes("function>identifier") == "fg");
+        CHECK(lexemes("function > parameter_list > identifier") == "ab");
+        CHECK(lexemes("file > identifier") == "");
+        CHECK(lexemes("file > * > identifier") == "fg");
+    }
+    SUBCASE("sibling")
+    {
+        CHECK(lexemes("identifier + comma") == ",");
+        CHECK(lexemes("comma + identifier") == "b");
+        CHECK(lexemes("identifier + identifier") == "");
+        CHECK(lexemes("identifier ~ identifier") == "b");
+        CHECK(lexemes("function ~ function") == "<prod>");
+        CHECK(lexemes("identifier ~ parameter_list > identifier") == "ab");
+    }
+    SUBCASE("subtree")
+    {
+        lexy_ext::parse_tree_query q("function > identifier");
+
+        auto count = 0;
+        q.for_each(tree, *tree.root().children().begin(), [&](auto node) {
+            CHECK(node.lexeme().begin() == input.data());
+            ++count;
+        });
+        CHECK(count == 1);
+    }
+    SUBCASE("invalid")
+    {
+        CHECK(!lexy_ext::parse_tree_query("").is_valid());
+        CHECK(!lexy_ext::parse_tree_query("  ").is_valid());
+        CHECK(!lexy_ext::parse_tree_query("> a").is_valid());
+        CHECK(!lexy_ext::parse_tree_query("a >").is_valid());
+        CHECK(!lexy_ext::parse_tree_query("a > > b").is_valid());
+        CHECK(lexy_ext::parse_tree_query("invalid >").find_all(tree).empty());
+    }
+}
@@ -0,0 +1,90 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#undef LEXY_DISABLE_FILE
+#include <lexy_ext/prefetching_file_source.hpp>
+
+#include <cstdio>
+#include <doctest/doctest.h>
+
+namespace
+{
+std::string test_file_name(int i)
+{
+    return "lexy-ext-prefetching-file-source-" + std::to_string(i) + ".test.delete-me";
+}
+
+void write_test_data(const std::string& path, std::size_t size, char c)
+{
+    auto file = std::fopen(path.c_str(), "wb");
+    for (auto i = std::size_t(0); i != size; ++i)
+        std::fputc(c, file);
+    std::fclose(file);
+}
+} // namespace
+
+TEST_CASE("prefetching_file_source")
+{
+    std::vector<std::string> paths;
+    for (auto i = 0; i != 16; ++i)
+    {
+        paths.push_back(test_file_name(i));
+        std::remove(paths.back().c_str());
+        if (i != 5)
+            write_test_data(paths.back(), std::size_t(i) * 1000, char('a' + i));
+    }
+
+    auto check_files = [&](lexy_ext::prefetching_file_source<>& source) {
+        for (auto i = 0; i != 16; ++i)
+        {
+            REQUIRE(!source.empty());
+            CHECK(source.next_index() == std::size_t(i));
+            CHECK(source.path(source.next_index()) == paths[std::size_t(i)]);
+
+            auto result = source.next();
+            if (i == 5)
+            {
+                CHECK(!result);
+                CHECK(result.error() == lexy::file_error::file_not_found);
+                continue;
+            }
+
+            REQUIRE(result);
+            REQUIRE(result.buffer().size() == std::size_t(i) * 1000);
+
+            auto all_equal = true;
+            for (auto j = std::size_t(0); j != result.buffer().size(); ++j)
+                if (result.buffer().data()[j] != char('a' + i))
+                    all_equal = false;
+            CHECK(all_equal);
+        }
+        CHECK(source.empty());
+    };
+
+    SUBCASE("default")
+    {
+        lexy_ext::prefetching_file_source<> source(paths);
+        check_files(source);
+    }
+    SUBCASE("depth")
+    {
+        lexy_ext::prefetching_file_source<> source(paths, 1);
+        check_files(source);
+    }
+    SUBCASE("memory cap")
+    {
+        // Smaller than most files.
+        lexy_ext::prefetching_file_source<> source(paths, 4, 2000);
+        check_files(source);
+    }
+    SUBCASE("destroyed early")
+    {
+        lexy_ext::prefetching_file_source<> source(paths, 2);
+        auto                                result = source.next();
+        CHECK(result);
+    }
+
+    for (auto& path : paths)
+        std::remove(path.c_str());
+}
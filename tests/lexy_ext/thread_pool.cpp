@@ -0,0 +1,74 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <lexy_ext/thread_pool.hpp>
+
+#include <doctest/doctest.h>
+#include <stdexcept>
+
+TEST_CASE("sequential_executor")
+{
+    lexy_ext::sequential_executor executor;
+
+    std::vector<std::size_t> indices;
+    executor.parallel_for(4, [&](std::size_t i) { indices.push_back(i); });
+    CHECK(indices == std::vector<std::size_t>{0, 1, 2, 3});
+}
+
+TEST_CASE("thread_pool")
+{
+    SUBCASE("single thread")
+    {
+        lexy_ext::thread_pool pool(1);
+        CHECK(pool.thread_count() == 1);
+
+        std::vector<std::size_t> indices;
+        pool.parallel_for(4, [&](std::size_t i) { indices.push_back(i); });
+        CHECK(indices == std::vector<std::size_t>{0, 1, 2, 3});
+    }
+    SUBCASE("multiple threads")
+    {
+        lexy_ext::thread_pool pool(4);
+        CHECK(pool.thread_count() == 4);
+
+        // Run multiple jobs to ensure the pool can be re-used.
+        for (auto job = 0; job != 16; ++job)
+        {
+            std::vector<std::atomic<int>> counts(1000);
+            pool.parallel_for(counts.size(), [&](std::size_t i) { ++counts[i]; });
+
+            auto all_once = true;
+            for (auto& count : counts)
+                if (count != 1)
+                    all_once = false;
+            CHECK(all_once);
+        }
+
+        auto called = false;
+        pool.parallel_for(0, [&](std::size_t) { called = true; });
+        CHECK(!called);
+    }
+    SUBCASE("exception")
+    {
+        lexy_ext::thread_pool pool(4);
+
+        std::atomic<int> count(0);
+        auto             thrown = false;
+        try
+        {
+            pool.parallel_for(100, [&](std::size_t i) {
+                ++count;
+                if (i == 42)
+                    throw std::runtime_error("42");
+            });
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+        // All other tasks are still executed.
+        CHECK(count == 100);
+    }
+}
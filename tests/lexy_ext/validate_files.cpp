@@ -0,0 +1,122 @@
+// Copyright (C) 2020-2021 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#undef LEXY_DISABLE_FILE
+#include <lexy_ext/validate_files.hpp>
+
+#include <cstdio>
+#include <doctest/doctest.h>
+#include <lexy/callback.hpp>
+#include <lexy/dsl/ascii.hpp>
+#include <lexy/dsl/eof.hpp>
+#include <lexy/dsl/identifier.hpp>
+#include <lexy/dsl/sequence.hpp>
+#include <string>
+
+namespace
+{
+namespace dsl = lexy::dsl;
+
+struct production
+{
+    static constexpr auto rule = dsl::identifier(dsl::ascii::alpha) + dsl::eof;
+};
+
+void write_test_data(const std::string& path, const char* data)
+{
+    auto file = std::fopen(path.c_str(), "wb");
+    std::fputs(data, file);
+    std::fclose(file);
+}
+} // namespace
+
+TEST_CASE("_vf_buffer_resource")
+{
+    lexy_ext::_vf_buffer_resource resource;
+
+    auto big = resource.allocate(1000, 1);
+    resource.deallocate(big, 1000, 1);
+
+    // A small file re-uses the block...
+    auto small = resource.allocate(10, 1);
+    CHECK(small == big);
+    resource.deallocate(small, 10, 1);
+
+    // ... which still has its full size afterwards.
+    auto medium = resource.allocate(500, 1);
+    CHECK(medium == big);
+    resource.deallocate(medium, 500, 1);
+
+    // A bigger block replaces it.
+    auto bigger = resource.allocate(2000, 1);
+    resource.deallocate(bigger, 2000, 1);
+    CHECK(resource.allocate(1500, 1) == bigger);
+    resource.deallocate(bigger, 1500, 1);
+}
+
+TEST_CASE("validate_files")
+{
+    std::vector<std::string> paths;
+    for (auto i = 0; i != 32; ++i)
+    {
+        auto path = "lexy-ext-validate-files-" + std::to_string(i) + ".test.delete-me";
+        if (i % 8 == 3)
+            write_test_data(path, "abc123");
+        else if (i % 8 != 5)
+            write_test_data(path, std::string(std::size_t(i + 1) * 100, 'a').c_str());
+        paths.push_back(path);
+    }
+
+    auto check_results = [&](const std::vector<lexy_ext::validate_file_result>& results) {
+        REQUIRE(results.size() == paths.size());
+        for (auto i = 0u; i != results.size(); ++i)
+        {
+            if (i % 8 == 3)
+            {
+                CHECK(!results[i]);
+                CHECK(results[i].was_read());
+                CHECK(results[i].error_count() == 1);
+            }
+            else if (i % 8 == 5)
+            {
+                CHECK(!results[i]);
+                CHECK(!results[i].was_read());
+                CHECK(results[i].read_error() == lexy::file_error::file_not_found);
+            }
+            else
+            {
+                CHECK(results[i]);
+                CHECK(results[i].error_count() == 0);
+            }
+        }
+    };
+
+    // Records the input of each reported error.
+    std::vector<const void*> reported;
+    auto                     callback = lexy::callback([&](const auto& context, const auto&) {
+        reported.push_back(context.input().data());
+    });
+
+    SUBCASE("sequential")
+    {
+        lexy_ext::sequential_executor executor;
+        check_results(lexy_ext::validate_files<production>(paths, executor, callback));
+        CHECK(reported.size() == 4);
+    }
+    SUBCASE("thread_pool")
+    {
+        check_results(lexy_ext::validate_files<production>(paths, 4, callback));
+        CHECK(reported.size() == 4);
+    }
+    SUBCASE("const char*")
+    {
+        std::vector<const char*> c_paths;
+        for (auto& path : paths)
+            c_paths.push_back(path.c_str());
+        check_results(lexy_ext::validate_files<production>(c_paths, 2, lexy::noop));
+    }
+
+    for (auto& path : paths)
+        std::remove(path.c_str());
+}